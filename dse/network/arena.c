@@ -0,0 +1,96 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dse/logger.h>
+#include <dse/network/network.h>
+
+
+/* Arena (bump allocator) for the objects of a Network. Allocations are zeroed
+and aligned, and are released together by network_arena_release(). Large
+allocations get a block of their own, the current block is kept. */
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN      16
+
+
+typedef struct NetworkArenaBlock {
+    NetworkArenaBlock* next;
+    size_t             size;
+    size_t             used;
+    uint8_t            data[];
+} NetworkArenaBlock;
+
+
+static NetworkArenaBlock* _arena_block(size_t size)
+{
+    NetworkArenaBlock* b = calloc(1, sizeof(NetworkArenaBlock) + size);
+    if (b == NULL) log_fatal("Arena block allocation failed (size=%zu)", size);
+    b->size = size;
+    return b;
+}
+
+
+static void* _block_alloc(NetworkArenaBlock* b, size_t size)
+{
+    uintptr_t base = (uintptr_t)b->data;
+    uintptr_t p = base + b->used + ARENA_ALIGN - 1;
+    p &= ~(uintptr_t)(ARENA_ALIGN - 1);
+    if (p + size > base + b->size) return NULL;
+    b->used = p + size - base;
+    return (void*)p;
+}
+
+
+void* network_arena_alloc(NetworkArena* a, size_t size)
+{
+    if (a->block) {
+        void* p = _block_alloc(a->block, size);
+        if (p) return p;
+    }
+
+    NetworkArenaBlock* b;
+    if (size > ARENA_BLOCK_SIZE / 4) {
+        /* Dedicated block, linked after the current block. */
+        b = _arena_block(size + ARENA_ALIGN);
+        if (a->block) {
+            b->next = a->block->next;
+            a->block->next = b;
+        } else {
+            a->block = b;
+        }
+    } else {
+        b = _arena_block(ARENA_BLOCK_SIZE);
+        b->next = a->block;
+        a->block = b;
+    }
+    a->size += b->size;
+    return _block_alloc(b, size);
+}
+
+
+char* network_arena_strdup(NetworkArena* a, const char* s)
+{
+    if (s == NULL) return NULL;
+    size_t len = strlen(s) + 1;
+    char*  p = network_arena_alloc(a, len);
+    memcpy(p, s, len);
+    return p;
+}
+
+
+void network_arena_release(NetworkArena* a)
+{
+    NetworkArenaBlock* b = a->block;
+    while (b) {
+        NetworkArenaBlock* next = b->next;
+        free(b);
+        b = next;
+    }
+    a->block = NULL;
+    a->size = 0;
+}
@@ -0,0 +1,143 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <dse/network/network.h>
+
+
+/* Linear codec for signals with factor/offset scaling:
+
+    encode: raw = (phys - offset) / factor
+    decode: phys = raw * factor + offset
+
+Range checks are made on the raw value with exclusive bounds. For integer
+types the bounds are set (network_linear_bounds) so that the check on the
+unconverted value is the same as the inclusive check of the truncated value
+(which the library functions make). The loops have no calls or dependent
+loads and are vectorized by the compiler (valid is a double mask so that the
+loops vectorize without AVX2), the AVX2 variant is selected at runtime. */
+
+#define LINEAR_CODEC(SUFFIX, ATTR)                                             \
+    ATTR static void _linear_encode##SUFFIX(size_t count,                      \
+        double* restrict value, const double* restrict factor,                 \
+        const double* restrict offset, const double* restrict lower,           \
+        const double* restrict upper, double* restrict valid)                  \
+    {                                                                          \
+        for (size_t i = 0; i < count; i++) {                                   \
+            double r = (value[i] - offset[i]) / factor[i];                     \
+            valid[i] = (r > lower[i]) & (r < upper[i]) ? 1.0 : 0.0;            \
+            value[i] = r;                                                      \
+        }                                                                      \
+    }                                                                          \
+    ATTR static void _linear_decode##SUFFIX(size_t count,                      \
+        double* restrict value, const double* restrict factor,                 \
+        const double* restrict offset, const double* restrict lower,           \
+        const double* restrict upper, double* restrict valid)                  \
+    {                                                                          \
+        for (size_t i = 0; i < count; i++) {                                   \
+            double r = value[i];                                               \
+            valid[i] = (r > lower[i]) & (r < upper[i]) ? valid[i] : 0.0;       \
+            value[i] = r * factor[i] + offset[i];                              \
+        }                                                                      \
+    }
+
+LINEAR_CODEC(, )
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LINEAR_CODEC_AVX2
+LINEAR_CODEC(_avx2, __attribute__((target("avx2"))))
+#endif
+
+
+NetworkLinearCodec network_linear_encoder(void)
+{
+#if defined(LINEAR_CODEC_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return _linear_encode_avx2;
+#endif
+    return _linear_encode;
+}
+
+
+NetworkLinearCodec network_linear_decoder(void)
+{
+#if defined(LINEAR_CODEC_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return _linear_decode_avx2;
+#endif
+    return _linear_decode;
+}
+
+
+/* Exclusive raw limits of each integer type. */
+static const struct {
+    double lower;
+    double upper;
+} __type_limit[NETWORK_SIGNAL_TYPE__COUNT] = {
+    [NETWORK_SIGNAL_TYPE_INT8] = { -129.0, 128.0 },
+    [NETWORK_SIGNAL_TYPE_UINT8] = { -1.0, 256.0 },
+    [NETWORK_SIGNAL_TYPE_INT16] = { -32769.0, 32768.0 },
+    [NETWORK_SIGNAL_TYPE_UINT16] = { -1.0, 65536.0 },
+    [NETWORK_SIGNAL_TYPE_INT32] = { -2147483649.0, 2147483648.0 },
+    [NETWORK_SIGNAL_TYPE_UINT32] = { -1.0, 4294967296.0 },
+    [NETWORK_SIGNAL_TYPE_INT64] = { -9223372036854775808.0,
+        9223372036854775808.0 },
+    [NETWORK_SIGNAL_TYPE_UINT64] = { -1.0, 18446744073709551616.0 },
+};
+
+
+static double _raw_round(double x)
+{
+    /* Nearest integer (values beyond 2^52 are already integral). */
+    if (x > 4503599627370496.0 || x < -4503599627370496.0) return x;
+    return (double)(int64_t)(x < 0 ? x - 0.5 : x + 0.5);
+}
+
+
+static double _toward_zero(double x)
+{
+    /* Adjacent double toward zero (x is finite and not zero). */
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits--;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+
+/* Exclusive raw bounds of a linear signal. For integer types a raw value r
+is valid when trunc(r) is in the inclusive raw range [min, max], the bound
+is widened by 1 only on the side of zero (where truncation moves the value
+into the range), otherwise it is moved to the adjacent double. */
+void network_linear_bounds(NetworkSignal* ns, double* lower, double* upper)
+{
+    if (ns->type == NETWORK_SIGNAL_TYPE_FLOAT ||
+        ns->type == NETWORK_SIGNAL_TYPE_DOUBLE ||
+        ns->type >= NETWORK_SIGNAL_TYPE__COUNT) {
+        *lower = -INFINITY;
+        *upper = INFINITY;
+        return;
+    }
+
+    /* Inclusive raw range. */
+    double min = _raw_round((ns->minimum - ns->offset) / ns->factor);
+    double max = _raw_round((ns->maximum - ns->offset) / ns->factor);
+    if (min > max) {
+        double _swap = min;
+        min = max;
+        max = _swap;
+    }
+
+    *lower = (min >= 1.0) ? _toward_zero(min) : min - 1.0;
+    *upper = (max <= -1.0) ? _toward_zero(max) : max + 1.0;
+    if (*lower < __type_limit[ns->type].lower) {
+        *lower = __type_limit[ns->type].lower;
+    }
+    if (*upper > __type_limit[ns->type].upper) {
+        *upper = __type_limit[ns->type].upper;
+    }
+}
@@ -19,32 +19,68 @@
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
 
-uint32_t simbus_generate_uid_hash(const uint8_t* key, size_t len)
+/* Word-at-a-time 64 bit hash (for callers which only need a checksum, change
+detection is made with network_message_buffer_changed()). */
+uint64_t network_hash64(const uint8_t* data, size_t len)
 {
-    // FNV-1a hash (http://www.isthe.com/chongo/tech/comp/fnv/)
-    uint32_t h = 2166136261UL; /* FNV_OFFSET 32 bit */
-    for (size_t i = 0; i < len; ++i) {
-        h = h ^ key[i];
-        h = h * 16777619UL; /* FNV_PRIME 32 bit */
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+    size_t   i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t w;
+        memcpy(&w, data + i, sizeof(uint64_t));
+        h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+    if (i < len) {
+        uint64_t w = 0;
+        memcpy(&w, data + i, len - i);
+        h = (h ^ w) * 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 29;
     }
     return h;
 }
 
 
-static NetworkMessage* _find_mux_message(
-    Network* n, uint32_t mux_id, uint32_t frame_id)
+static bool _buffer_equal(const uint8_t* a, const uint8_t* b, size_t len)
 {
-    if (mux_id == 0) return NULL;
-    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
-        if (nm->frame_id == frame_id) {
-            if (nm->mux_id == mux_id) {
-                return nm;
-            }
-        }
+    /* Larger buffers, libc memcmp is vectorized. */
+    if (len > 64) return memcmp(a, b, len) == 0;
+
+    uint64_t diff = 0;
+    size_t   i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t x, y;
+        memcpy(&x, a + i, sizeof(uint64_t));
+        memcpy(&y, b + i, sizeof(uint64_t));
+        diff |= x ^ y;
+    }
+    for (; i < len; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+
+/* Change detection, the message buffer is compared with a shadow copy which
+is taken (committed) at the last RX/TX of the message. An invalid shadow copy
+(i.e. reset by the schedule) is always a change. */
+bool network_message_buffer_changed(NetworkMessage* nm)
+{
+    if (nm->buffer_shadow_valid == false) return true;
+    if (nm->buffer_len == 0) return false;
+    return !_buffer_equal(nm->buffer, nm->buffer_shadow, nm->buffer_len);
+}
+
+
+void network_message_buffer_commit(NetworkMessage* nm)
+{
+    if (nm->buffer_len && nm->buffer_shadow) {
+        memcpy(nm->buffer_shadow, nm->buffer, nm->buffer_len);
     }
-    return NULL;
+    nm->buffer_shadow_valid = true;
 }
 
+
 static void _process_message(
     Network* n, NetworkMessage* nm, NCodecCanMessage* msg)
 {
@@ -55,14 +91,17 @@ static void _process_message(
             -rc, nm->frame_id);
         return;
     }
+    /* Frame received, rearm the RX deadline. */
+    network_schedule_rx(n, nm);
+    /* The buffer was overwritten, re-marshal on next TX. */
+    network_message_changed(n, nm);
     if (nm->mux_signal && nm->mux_signal->mux_mi) {
         /* This is a container message, also process the contained message. */
         MarshalItem* mi = nm->mux_signal->mux_mi;
         network_marshal_messages_to_signals(n, mi, true);
         uint32_t        mux_id = n->signal_vector[mi->signal_vector_index];
         /* Locate the mux message. */
-        NetworkMessage* mux_message =
-            _find_mux_message(n, mux_id, msg->frame_id);
+        NetworkMessage* mux_message = network_find_mux_message(n, nm, mux_id);
         if (mux_message) {
             _process_message(n, mux_message, msg);
         } else {
@@ -72,35 +111,23 @@ static void _process_message(
         }
     }
 
-    /* Calculate the checksum for the payload. */
-    uint32_t payload_checksum =
-        simbus_generate_uid_hash(nm->buffer, nm->buffer_len);
+    /* Detect changes to the buffer (since the last RX/TX). */
     nm->update_signals = false;
-    if (payload_checksum == nm->buffer_checksum) {
-        log_debug("Filtered message RX, no change detected in checksum %d, "
-                  "(frame_id=%d, checksum %d)",
-            payload_checksum, nm->frame_id, nm->buffer_checksum);
+    if (network_message_buffer_changed(nm) == false) {
+        log_debug("Filtered message RX, no change detected (frame_id=%d)",
+            nm->frame_id);
         return;
     }
-    nm->buffer_checksum = payload_checksum;
-    nm->update_signals = true;
-    log_debug("New message RX, updated checksum %d (frame_id=%d)",
-        payload_checksum, nm->frame_id);
+    network_message_buffer_commit(nm);
+    network_message_update(n, nm);
+    log_debug("New message RX, buffer changed (frame_id=%d)", nm->frame_id);
 }
 
 static void _process_can_frame(Network* n, NCodecCanMessage* msg)
 {
     /* Find the matching message. */
-    NetworkMessage* message = NULL;
-    NetworkMessage* nm = n->messages;
-    while (nm->frame_id) {
-        if (nm->frame_id == msg->frame_id) {
-            message = nm;
-            break;
-        }
-        /* Next message. */
-        nm++;
-    }
+    NetworkMessage* message =
+        network_find_message(n, msg->frame_id, msg->frame_type);
     if (message) {
         _process_message(n, message, msg);
     } else {
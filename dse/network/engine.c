@@ -4,6 +4,7 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <math.h>
 #include <assert.h>
 #include <dlfcn.h>
 #include <dse/testing.h>
@@ -17,14 +18,187 @@
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
 
+/* Frame index keys, messages are indexed with their frame_type and also
+with FRAME_TYPE_ANY (for frames received without the expected frame_type). */
+#define FRAME_TYPE_ANY 0x100
+
+static uint64_t _frame_key(uint32_t frame_id, uint32_t frame_type)
+{
+    return ((uint64_t)frame_type << 32) | frame_id;
+}
+
+
+static size_t _index_slot(size_t size, uint64_t key)
+{
+    /* Fibonacci hashing (size is a power of 2). */
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+}
+
+
+static void _index_insert(
+    NetworkFrameIndex* index, size_t size, uint64_t key, NetworkMessage* nm)
+{
+    size_t slot = _index_slot(size, key);
+    while (index[slot].message) {
+        /* First message wins (i.e. the container of contained messages). */
+        if (index[slot].key == key) return;
+        slot = (slot + 1) & (size - 1);
+    }
+    index[slot].key = key;
+    index[slot].message = nm;
+}
+
+
+static NetworkMessage* _index_find(
+    NetworkFrameIndex* index, size_t size, uint64_t key)
+{
+    size_t slot = _index_slot(size, key);
+    while (index[slot].message) {
+        if (index[slot].key == key) return index[slot].message;
+        slot = (slot + 1) & (size - 1);
+    }
+    return NULL;
+}
+
+
+static void _load_frame_index(Network* n, size_t message_count)
+{
+    /* Two keys per message, load factor <= 0.5. */
+    n->frame_index_size = 4;
+    while (n->frame_index_size < message_count * 4) {
+        n->frame_index_size *= 2;
+    }
+    n->frame_index = network_arena_alloc(
+        &n->arena, n->frame_index_size * sizeof(NetworkFrameIndex));
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        _index_insert(n->frame_index, n->frame_index_size,
+            _frame_key(nm->frame_id, nm->frame_type), nm);
+    }
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        _index_insert(n->frame_index, n->frame_index_size,
+            _frame_key(nm->frame_id, FRAME_TYPE_ANY), nm);
+    }
+}
+
+
+static bool _is_contained(NetworkMessage* container, NetworkMessage* nm)
+{
+    return (nm != container && nm->frame_id == container->frame_id &&
+            nm->mux_id != 0);
+}
+
+
+static void _load_mux_index(Network* n)
+{
+    /* Size the index of each container message (load factor <= 0.5). */
+    size_t total = 0;
+    for (NetworkMessage* c = n->messages; c && c->name; c++) {
+        c->mux_index = NULL;
+        c->mux_index_size = 0;
+        if (c->mux_signal == NULL) continue;
+        size_t count = 0;
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            if (_is_contained(c, nm)) count++;
+        }
+        c->mux_index_size = 2;
+        while (c->mux_index_size < count * 2) {
+            c->mux_index_size *= 2;
+        }
+        total += c->mux_index_size;
+    }
+    if (total == 0) return;
+
+    /* Single allocation, each container holds a slice. */
+    n->mux_index =
+        network_arena_alloc(&n->arena, total * sizeof(NetworkFrameIndex));
+    NetworkFrameIndex* slice = n->mux_index;
+    for (NetworkMessage* c = n->messages; c && c->name; c++) {
+        if (c->mux_index_size == 0) continue;
+        c->mux_index = slice;
+        slice += c->mux_index_size;
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            if (_is_contained(c, nm) == false) continue;
+            _index_insert(c->mux_index, c->mux_index_size, nm->mux_id, nm);
+        }
+    }
+}
+
+
+/* Find the message for a received frame. A message with matching frame_id
+and frame_type is preferred, otherwise the first message with the frame_id. */
+NetworkMessage* network_find_message(
+    Network* n, uint32_t frame_id, uint8_t frame_type)
+{
+    if (n == NULL) return NULL;
+    if (n->frame_index == NULL) {
+        /* No index, search the message list. */
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            if (nm->frame_id == frame_id) return nm;
+        }
+        return NULL;
+    }
+
+    NetworkMessage* nm = _index_find(n->frame_index, n->frame_index_size,
+        _frame_key(frame_id, frame_type));
+    if (nm == NULL) {
+        nm = _index_find(n->frame_index, n->frame_index_size,
+            _frame_key(frame_id, FRAME_TYPE_ANY));
+    }
+    return nm;
+}
+
+
+/* Find the contained message of a container message (by mux_id). */
+NetworkMessage* network_find_mux_message(
+    Network* n, NetworkMessage* container, uint32_t mux_id)
+{
+    if (n == NULL || container == NULL || mux_id == 0) return NULL;
+    if (container->mux_index == NULL) {
+        /* No index, search the message list. */
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            if (nm->frame_id == container->frame_id && nm->mux_id == mux_id) {
+                return nm;
+            }
+        }
+        return NULL;
+    }
+    return _index_find(container->mux_index, container->mux_index_size, mux_id);
+}
+
+
+static void _encode_init_value(
+    NetworkMessage* nm, NetworkSignal* ns, NetworkSignalInfo* si);
+
+
 int network_load_marshal_lists(Network* n)
 {
     assert(n);
     assert(n->name);
 
-    HashList m_list;
-    hashlist_init(&m_list, 100);
+    /* Count the signals. */
+    size_t count = 0;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        if (nm->buffer_len == 0) {
+            nm++;
+            continue;
+        }
+        for (NetworkSignalInfo* si = nm->signal_info; si && si->name; si++) {
+            if (nm->signals[si - nm->signal_info].inactive == false) count++;
+        }
+    }
+
+    /* Inactive signals are not marshalled, encode their init_value. */
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        for (NetworkSignalInfo* si = nm->signal_info; si && si->name; si++) {
+            NetworkSignal* ns = &nm->signals[si - nm->signal_info];
+            if (ns->inactive) _encode_init_value(nm, ns, si);
+        }
+    }
 
+    /* Create the (NULL terminated) list. */
+    n->marshal_list =
+        network_arena_alloc(&n->arena, (count + 1) * sizeof(MarshalItem));
+    MarshalItem* mi = n->marshal_list;
     for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
         if (nm->buffer_len == 0) {
             /* Next message. */
@@ -33,26 +207,17 @@ int network_load_marshal_lists(Network* n)
             continue;
         }
         /* Signals. */
-        for (NetworkSignal* ns = nm->signals; ns && ns->name; ns++) {
-            /* Create an MI object. */
-            MarshalItem* mi = calloc(1, sizeof(MarshalItem));
+        for (NetworkSignalInfo* si = nm->signal_info; si && si->name; si++) {
+            NetworkSignal* ns = &nm->signals[si - nm->signal_info];
+            if (ns->inactive) continue;
             mi->signal = ns;
+            mi->info = si;
             mi->message = nm;
-            log_debug("MarshalItem, name: %s", ns->signal_name);
-            hashlist_append(&m_list, mi);
+            log_debug("MarshalItem, name: %s", si->signal_name);
+            mi++;
         }
     }
 
-    /* Convert the HashList to a NULL terminated list. */
-    size_t count = hashlist_length(&m_list);
-    n->marshal_list = calloc(count + 1, sizeof(MarshalItem));
-    for (uint32_t i = 0; i < count; i++) {
-        memcpy(
-            &n->marshal_list[i], hashlist_at(&m_list, i), sizeof(MarshalItem));
-        free(hashlist_at(&m_list, i));
-    }
-    hashlist_destroy(&m_list);
-
     /* Set any mux_mi references. */
     for (MarshalItem* mi = n->marshal_list; mi && mi->signal; mi++) {
         if (mi->signal->mux_signal) {
@@ -61,6 +226,27 @@ int network_load_marshal_lists(Network* n)
         }
     }
 
+    /* Message marshal items (marshal_list is ordered by message). */
+    size_t message_count = 0;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        nm->marshal_items = NULL;
+        nm->marshal_count = 0;
+        nm->marshal_index = NULL;
+        nm->marshal_slices = NULL;
+        nm->marshal_slice_count = 0;
+        nm->update_queued = false;
+        message_count++;
+    }
+    for (MarshalItem* mi = n->marshal_list; mi && mi->signal; mi++) {
+        if (mi->message->marshal_items == NULL) mi->message->marshal_items = mi;
+        mi->message->marshal_count++;
+    }
+    n->update_list = network_arena_alloc(
+        &n->arena, (message_count + 1) * sizeof(NetworkMessage*));
+    n->update_count = 0;
+    _load_frame_index(n, message_count);
+    _load_mux_index(n);
+
     return 0;
 }
 
@@ -95,7 +281,7 @@ int network_get_signal_names(
             /* Internal signal, prevent matching with ModelC signals.*/
             names[name_idx] = "";
         } else {
-            names[name_idx] = ns->signal_name;
+            names[name_idx] = mi->info->signal_name;
         }
         mi->signal_vector_index = sv_offset;
         name_idx++;
@@ -111,364 +297,692 @@ int network_get_signal_names(
 }
 
 
-int network_marshal_signals_to_messages(Network* n, MarshalItem* marshal_list)
+/* Marshal kernels, one per NetworkSignalType (selected by table lookup). */
+typedef void (*EncodeKernel)(MarshalItem* mi, double signal_value);
+typedef void (*DecodeKernel)(Network* n, MarshalItem* mi);
+
+#define MARSHAL_KERNELS(NAME, T, FT)                                           \
+    static void _encode_##NAME(MarshalItem* mi, double signal_value)           \
+    {                                                                          \
+        T _value = ((EncodeFunc##FT)mi->signal->encode_func)(signal_value);    \
+        if (((RangeFunc##FT)mi->signal->range_func)(_value)) {                 \
+            ((T*)mi->message->buffer)[mi->signal->buffer_offset / sizeof(T)] = \
+                _value;                                                        \
+            log_debug("calling encode_func (%f -> %f): %s", signal_value,      \
+                (double)_value, mi->info->name);                               \
+        }                                                                      \
+    }                                                                          \
+    static void _decode_##NAME(Network* n, MarshalItem* mi)                    \
+    {                                                                          \
+        T _value =                                                             \
+            ((T*)mi->message->buffer)[mi->signal->buffer_offset / sizeof(T)];  \
+        if (((RangeFunc##FT)mi->signal->range_func)(_value)) {                 \
+            double _v = ((DecodeFunc##FT)mi->signal->decode_func)(_value);     \
+            n->signal_vector[mi->signal_vector_index] = _v;                    \
+            log_debug("calling decode_func (%f -> %f): %s", (double)_value,    \
+                _v, mi->info->name);                                           \
+        }                                                                      \
+    }                                                                          \
+    static void _store_##NAME(void* data, double value)                        \
+    {                                                                          \
+        *(T*)data = (T)value;                                                  \
+    }                                                                          \
+    static void _plan_encode_##NAME(                                           \
+        Network* n, MarshalGroup* g, size_t begin, size_t end)                 \
+    {                                                                          \
+        size_t _linear_end = end < g->linear_count ? end : g->linear_count;    \
+        if (begin < _linear_end) {                                             \
+            for (size_t i = begin; i < _linear_end; i++) {                     \
+                g->value[i] = g->constant[i] ? *g->constant[i]                 \
+                                             : n->signal_vector[g->index[i]];  \
+            }                                                                  \
+            n->marshal_plan->linear_encode(_linear_end - begin,                \
+                g->value + begin, g->factor + begin, g->offset + begin,        \
+                g->lower + begin, g->upper + begin, g->valid + begin);         \
+            for (size_t i = begin; i < _linear_end; i++) {                     \
+                if (g->valid[i]) *(T*)g->data[i] = (T)g->value[i];             \
+            }                                                                  \
+        }                                                                      \
+        for (size_t i = begin > _linear_end ? begin : _linear_end; i < end;    \
+             i++) {                                                            \
+            double _signal_value = g->constant[i]                              \
+                                       ? *g->constant[i]                       \
+                                       : n->signal_vector[g->index[i]];        \
+            T _value = ((EncodeFunc##FT)g->encode_func[i])(_signal_value);     \
+            if (((RangeFunc##FT)g->range_func[i])(_value)) {                   \
+                *(T*)g->data[i] = _value;                                      \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+    static void _plan_decode_##NAME(                                           \
+        Network* n, MarshalGroup* g, size_t begin, size_t end, bool force)     \
+    {                                                                          \
+        size_t _linear_end = end < g->linear_count ? end : g->linear_count;    \
+        if (begin < _linear_end) {                                             \
+            for (size_t i = begin; i < _linear_end; i++) {                     \
+                g->valid[i] = (force || *g->update[i]) ? 1.0 : 0.0;            \
+                g->value[i] = (double)*(T*)g->data[i];                         \
+            }                                                                  \
+            n->marshal_plan->linear_decode(_linear_end - begin,                \
+                g->value + begin, g->factor + begin, g->offset + begin,        \
+                g->lower + begin, g->upper + begin, g->valid + begin);         \
+            for (size_t i = begin; i < _linear_end; i++) {                     \
+                if (g->valid[i]) n->signal_vector[g->index[i]] = g->value[i];  \
+            }                                                                  \
+        }                                                                      \
+        for (size_t i = begin > _linear_end ? begin : _linear_end; i < end;    \
+             i++) {                                                            \
+            if (force == false && *g->update[i] == false) continue;            \
+            T _value = *(T*)g->data[i];                                        \
+            if (((RangeFunc##FT)g->range_func[i])(_value)) {                   \
+                n->signal_vector[g->index[i]] =                                \
+                    ((DecodeFunc##FT)g->decode_func[i])(_value);               \
+            }                                                                  \
+        }                                                                      \
+    }
+
+MARSHAL_KERNELS(int8, int8_t, Int8)
+MARSHAL_KERNELS(uint8, uint8_t, Int8)
+MARSHAL_KERNELS(int16, int16_t, Int16)
+MARSHAL_KERNELS(uint16, uint16_t, Int16)
+MARSHAL_KERNELS(int32, int32_t, Int32)
+MARSHAL_KERNELS(uint32, uint32_t, Int32)
+MARSHAL_KERNELS(int64, int64_t, Int64)
+MARSHAL_KERNELS(uint64, uint64_t, Int64)
+MARSHAL_KERNELS(float, float, Float)
+MARSHAL_KERNELS(double, double, Double)
+
+static void _encode_unknown(MarshalItem* mi, double signal_value)
 {
-    if (n == NULL || marshal_list == NULL) return 1;
-    for (MarshalItem* mi = marshal_list; mi && mi->signal; mi++) {
-        double _signal_value = n->signal_vector[mi->signal_vector_index];
-        if (mi->signal->internal && mi->message->container) {
-            /* Internal signals on container messages take a constant value. */
-            _signal_value = mi->signal->value;
+    UNUSED(signal_value);
+    log_error("Unknown type: %s (frame_id=%d, message=%s, signal=%s)",
+        mi->info->member_type, mi->message->frame_id, mi->message->name,
+        mi->info->name);
+}
+
+static void _decode_unknown(Network* n, MarshalItem* mi)
+{
+    UNUSED(n);
+    _encode_unknown(mi, 0);
+}
+
+static const EncodeKernel __encode_kernel[NETWORK_SIGNAL_TYPE__COUNT] = {
+    [NETWORK_SIGNAL_TYPE_UNKNOWN] = _encode_unknown,
+    [NETWORK_SIGNAL_TYPE_INT8] = _encode_int8,
+    [NETWORK_SIGNAL_TYPE_UINT8] = _encode_uint8,
+    [NETWORK_SIGNAL_TYPE_INT16] = _encode_int16,
+    [NETWORK_SIGNAL_TYPE_UINT16] = _encode_uint16,
+    [NETWORK_SIGNAL_TYPE_INT32] = _encode_int32,
+    [NETWORK_SIGNAL_TYPE_UINT32] = _encode_uint32,
+    [NETWORK_SIGNAL_TYPE_INT64] = _encode_int64,
+    [NETWORK_SIGNAL_TYPE_UINT64] = _encode_uint64,
+    [NETWORK_SIGNAL_TYPE_FLOAT] = _encode_float,
+    [NETWORK_SIGNAL_TYPE_DOUBLE] = _encode_double,
+};
+
+static const DecodeKernel __decode_kernel[NETWORK_SIGNAL_TYPE__COUNT] = {
+    [NETWORK_SIGNAL_TYPE_UNKNOWN] = _decode_unknown,
+    [NETWORK_SIGNAL_TYPE_INT8] = _decode_int8,
+    [NETWORK_SIGNAL_TYPE_UINT8] = _decode_uint8,
+    [NETWORK_SIGNAL_TYPE_INT16] = _decode_int16,
+    [NETWORK_SIGNAL_TYPE_UINT16] = _decode_uint16,
+    [NETWORK_SIGNAL_TYPE_INT32] = _decode_int32,
+    [NETWORK_SIGNAL_TYPE_UINT32] = _decode_uint32,
+    [NETWORK_SIGNAL_TYPE_INT64] = _decode_int64,
+    [NETWORK_SIGNAL_TYPE_UINT64] = _decode_uint64,
+    [NETWORK_SIGNAL_TYPE_FLOAT] = _decode_float,
+    [NETWORK_SIGNAL_TYPE_DOUBLE] = _decode_double,
+};
+
+typedef void (*StoreKernel)(void* data, double value);
+
+static const StoreKernel __store_kernel[NETWORK_SIGNAL_TYPE__COUNT] = {
+    [NETWORK_SIGNAL_TYPE_INT8] = _store_int8,
+    [NETWORK_SIGNAL_TYPE_UINT8] = _store_uint8,
+    [NETWORK_SIGNAL_TYPE_INT16] = _store_int16,
+    [NETWORK_SIGNAL_TYPE_UINT16] = _store_uint16,
+    [NETWORK_SIGNAL_TYPE_INT32] = _store_int32,
+    [NETWORK_SIGNAL_TYPE_UINT32] = _store_uint32,
+    [NETWORK_SIGNAL_TYPE_INT64] = _store_int64,
+    [NETWORK_SIGNAL_TYPE_UINT64] = _store_uint64,
+    [NETWORK_SIGNAL_TYPE_FLOAT] = _store_float,
+    [NETWORK_SIGNAL_TYPE_DOUBLE] = _store_double,
+};
+
+typedef void (*PlanEncodeKernel)(
+    Network* n, MarshalGroup* g, size_t begin, size_t end);
+typedef void (*PlanDecodeKernel)(
+    Network* n, MarshalGroup* g, size_t begin, size_t end, bool force);
+
+static const PlanEncodeKernel
+    __plan_encode_kernel[NETWORK_SIGNAL_TYPE__COUNT] = {
+    [NETWORK_SIGNAL_TYPE_INT8] = _plan_encode_int8,
+    [NETWORK_SIGNAL_TYPE_UINT8] = _plan_encode_uint8,
+    [NETWORK_SIGNAL_TYPE_INT16] = _plan_encode_int16,
+    [NETWORK_SIGNAL_TYPE_UINT16] = _plan_encode_uint16,
+    [NETWORK_SIGNAL_TYPE_INT32] = _plan_encode_int32,
+    [NETWORK_SIGNAL_TYPE_UINT32] = _plan_encode_uint32,
+    [NETWORK_SIGNAL_TYPE_INT64] = _plan_encode_int64,
+    [NETWORK_SIGNAL_TYPE_UINT64] = _plan_encode_uint64,
+    [NETWORK_SIGNAL_TYPE_FLOAT] = _plan_encode_float,
+    [NETWORK_SIGNAL_TYPE_DOUBLE] = _plan_encode_double,
+};
+
+static const PlanDecodeKernel
+    __plan_decode_kernel[NETWORK_SIGNAL_TYPE__COUNT] = {
+    [NETWORK_SIGNAL_TYPE_INT8] = _plan_decode_int8,
+    [NETWORK_SIGNAL_TYPE_UINT8] = _plan_decode_uint8,
+    [NETWORK_SIGNAL_TYPE_INT16] = _plan_decode_int16,
+    [NETWORK_SIGNAL_TYPE_UINT16] = _plan_decode_uint16,
+    [NETWORK_SIGNAL_TYPE_INT32] = _plan_decode_int32,
+    [NETWORK_SIGNAL_TYPE_UINT32] = _plan_decode_uint32,
+    [NETWORK_SIGNAL_TYPE_INT64] = _plan_decode_int64,
+    [NETWORK_SIGNAL_TYPE_UINT64] = _plan_decode_uint64,
+    [NETWORK_SIGNAL_TYPE_FLOAT] = _plan_decode_float,
+    [NETWORK_SIGNAL_TYPE_DOUBLE] = _plan_decode_double,
+};
+
+
+static void _plan_set_funcs(MarshalGroup* g, size_t i, NetworkSignal* ns)
+{
+    network_signal_get_funcs(
+        ns, &g->encode_func[i], &g->decode_func[i], &g->range_func[i]);
+}
+
+
+static bool _is_integer_type(NetworkSignalType type)
+{
+    return (type != NETWORK_SIGNAL_TYPE_FLOAT &&
+            type != NETWORK_SIGNAL_TYPE_DOUBLE);
+}
+
+
+/* Signals with linear scaling are marshalled by the native codec. */
+bool network_signal_linear(NetworkSignal* ns)
+{
+    if (ns->linear == false) return false;
+    bool bounded = (ns->minimum > -INFINITY && ns->maximum < INFINITY);
+    if (_is_integer_type(ns->type)) {
+        /* Integer types need a range (raw limits of the DBC signal). */
+        return bounded;
+    } else {
+        /* Float types are unchecked, with a range use the library. */
+        return !bounded;
+    }
+}
+
+
+static void _plan_set_linear(MarshalGroup* g, size_t i, NetworkSignal* ns)
+{
+    g->factor[i] = ns->factor;
+    g->offset[i] = ns->offset;
+    network_linear_bounds(ns, &g->lower[i], &g->upper[i]);
+}
+
+
+/* Encode the init_value of an inactive signal (lazy loading) to the message
+buffer, once at load, so that the message carries the same value for the
+signal as when it is marshalled. */
+static void _encode_init_value(
+    NetworkMessage* nm, NetworkSignal* ns, NetworkSignalInfo* si)
+{
+    if (nm->buffer == NULL || ns->type == NETWORK_SIGNAL_TYPE_UNKNOWN) return;
+    if (network_signal_linear(ns)) {
+        double value = si->init_value;
+        double lower, upper, valid;
+        network_linear_bounds(ns, &lower, &upper);
+        network_linear_encoder()(
+            1, &value, &ns->factor, &ns->offset, &lower, &upper, &valid);
+        if (valid) {
+            __store_kernel[ns->type](
+                (uint8_t*)nm->buffer + ns->buffer_offset, value);
         }
+    } else if (ns->encode_func && ns->range_func) {
+        MarshalItem mi = { .signal = ns, .info = si, .message = nm };
+        __encode_kernel[ns->type](&mi, si->init_value);
+    }
+}
 
-        if (strcmp(mi->signal->member_type, "uint8_t") == 0) {
-            uint8_t _value = 0;
-            _value = mi->signal->encode_func_int8(_signal_value);
-            if (mi->signal->range_func_int8(_value)) {
-                ((int8_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                               sizeof(int8_t)] = _value;
-
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((uint8_t*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                    sizeof(uint8_t)],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "uint16_t") == 0) {
-            uint16_t _value = 0;
-            _value = mi->signal->encode_func_int16(_signal_value);
-            if (mi->signal->range_func_int16(_value)) {
-                ((int16_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                sizeof(int16_t)] = _value;
-
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((uint16_t*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                     sizeof(uint16_t)],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "uint32_t") == 0) {
-            uint32_t _value = 0;
-            _value = mi->signal->encode_func_int32(_signal_value);
-            if (mi->signal->range_func_int32(_value)) {
-                ((int32_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                sizeof(int32_t)] = _value;
-
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((uint32_t*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                     sizeof(uint32_t)],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "uint64_t") == 0) {
-            uint64_t _value = 0;
-            _value = mi->signal->encode_func_int64(_signal_value);
-            if (mi->signal->range_func_int64(_value)) {
-                ((int64_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                sizeof(int64_t)] = _value;
-
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((uint64_t*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                     sizeof(uint64_t)],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "int8_t") == 0) {
-            int8_t _value = 0;
-            _value = mi->signal->encode_func_int8(_signal_value);
-            if (mi->signal->range_func_int8(_value)) {
-                ((int8_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                               sizeof(int8_t)] = _value;
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((int8_t*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                   sizeof(int8_t)],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "int16_t") == 0) {
-            int16_t _value = 0;
-            _value = mi->signal->encode_func_int16(_signal_value);
-            if (mi->signal->range_func_int16(_value)) {
-                ((int16_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                sizeof(int16_t)] = _value;
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((int16_t*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                    sizeof(int16_t)],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "int32_t") == 0) {
-            int32_t _value = 0;
-            _value = mi->signal->encode_func_int32(_signal_value);
-            if (mi->signal->range_func_int32(_value)) {
-                ((int32_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                sizeof(int32_t)] = _value;
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((int32_t*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                    sizeof(int32_t)],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "int64_t") == 0) {
-            int16_t _value = 0;
-            _value = mi->signal->encode_func_int64(_signal_value);
-            if (mi->signal->range_func_int64(_value)) {
-                ((int64_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                sizeof(int64_t)] = _value;
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((int64_t*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                    sizeof(int64_t)],
-                    mi->signal->name);
+
+static bool _load_marshal_index(NetworkMessage* nm, uint32_t* index)
+{
+    /* All message signals must be marshalled by the fused functions. */
+    size_t count = 0;
+    for (const char** name = nm->marshal_signals; *name; name++) {
+        if (count == nm->marshal_count) return false;
+        MarshalItem* item = NULL;
+        for (size_t i = 0; i < nm->marshal_count; i++) {
+            NetworkSignalInfo* si = nm->marshal_items[i].info;
+            if (si->name && strcmp(si->name, *name) == 0) {
+                item = &nm->marshal_items[i];
+                break;
             }
-        } else if (strcmp(mi->signal->member_type, "float") == 0) {
-            float _value = 0;
-            _value = mi->signal->encode_func_float(_signal_value);
-            if (mi->signal->range_func_float(_value)) {
-                ((float*)mi->message
-                        ->buffer)[(mi->signal->buffer_offset) / sizeof(float)] =
-                    _value;
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((float*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                  sizeof(float)],
-                    mi->signal->name);
+        }
+        if (item == NULL || item->signal->internal) return false;
+        index[count++] = item->signal_vector_index;
+    }
+    return (count == nm->marshal_count);
+}
+
+
+static size_t _load_marshal_slices(
+    MarshalPlan* plan, NetworkMessage* nm, MarshalSlice* slices)
+{
+    /* The items of a message are contiguous in each group (marshal_list
+    order is kept), separately for linear and library items. When slices is
+    NULL, only count the slices. */
+    size_t count = 0;
+    for (size_t t = 1; t < NETWORK_SIGNAL_TYPE__COUNT; t++) {
+        for (int linear = 1; linear >= 0; linear--) {
+            MarshalSlice s = { .type = t };
+            for (size_t i = 0; i < nm->marshal_count; i++) {
+                MarshalItem* mi = &nm->marshal_items[i];
+                if (mi->signal->type != t) continue;
+                if ((mi->plan_index < plan->group[t].linear_count) != linear) {
+                    continue;
+                }
+                if (s.end && s.end == mi->plan_index) {
+                    s.end++;
+                    continue;
+                }
+                if (s.end) {
+                    if (slices) slices[count] = s;
+                    count++;
+                }
+                s.begin = mi->plan_index;
+                s.end = mi->plan_index + 1;
             }
-        } else if (strcmp(mi->signal->member_type, "double") == 0) {
-            double _value = 0;
-            _value = mi->signal->encode_func_double(_signal_value);
-            if (mi->signal->range_func_double(_value)) {
-                ((double*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                               sizeof(double)] = _value;
-                log_debug("calling encode_func (%f -> %d): %d %s",
-                    _signal_value, _value,
-                    ((double*)mi->message->buffer)[mi->signal->buffer_offset /
-                                                   sizeof(double)],
-                    mi->signal->name);
+            if (s.end) {
+                if (slices) slices[count] = s;
+                count++;
             }
-        } else {
+        }
+    }
+    return count;
+}
+
+
+static void* _plan_alloc(Network* n, size_t count, size_t size)
+{
+    return network_arena_alloc(&n->arena, count * size);
+}
+
+
+/* Compile the marshal_list into a MarshalPlan, call after
+network_get_signal_names() (which sets the signal_vector_index). */
+int network_load_marshal_plan(Network* n)
+{
+    assert(n);
+    if (n->marshal_list == NULL) return 1;
+    network_unload_marshal_plan(n);
+
+    MarshalPlan* plan = network_arena_alloc(&n->arena, sizeof(MarshalPlan));
+    plan->linear_encode = network_linear_encoder();
+    plan->linear_decode = network_linear_decoder();
+
+    /* Count the items of each type. */
+    for (MarshalItem* mi = n->marshal_list; mi && mi->signal; mi++) {
+        NetworkSignal* ns = mi->signal;
+        if (ns->type == NETWORK_SIGNAL_TYPE_UNKNOWN ||
+            ns->type >= NETWORK_SIGNAL_TYPE__COUNT) {
             log_error("Unknown type: %s (frame_id=%d, message=%s, signal=%s)",
-                mi->signal->member_type, mi->message->frame_id,
-                mi->message->name, mi->signal->name);
+                mi->info->member_type, mi->message->frame_id,
+                mi->message->name, mi->info->name);
+            continue;
+        }
+        plan->group[ns->type].count++;
+        if (network_signal_linear(ns)) plan->group[ns->type].linear_count++;
+    }
+
+    /* Allocate the group arrays. */
+    size_t fill[NETWORK_SIGNAL_TYPE__COUNT] = { 0 };
+    size_t fill_linear[NETWORK_SIGNAL_TYPE__COUNT] = { 0 };
+    for (size_t t = 0; t < NETWORK_SIGNAL_TYPE__COUNT; t++) {
+        MarshalGroup* g = &plan->group[t];
+        if (g->count == 0) continue;
+        g->data = _plan_alloc(n, g->count, sizeof(uint8_t*));
+        g->index = _plan_alloc(n, g->count, sizeof(size_t));
+        g->encode_func = _plan_alloc(n, g->count, sizeof(void*));
+        g->decode_func = _plan_alloc(n, g->count, sizeof(void*));
+        g->range_func = _plan_alloc(n, g->count, sizeof(void*));
+        g->update = _plan_alloc(n, g->count, sizeof(bool*));
+        g->constant = _plan_alloc(n, g->count, sizeof(double*));
+        if (g->linear_count) {
+            g->factor = _plan_alloc(n, g->linear_count, sizeof(double));
+            g->offset = _plan_alloc(n, g->linear_count, sizeof(double));
+            g->lower = _plan_alloc(n, g->linear_count, sizeof(double));
+            g->upper = _plan_alloc(n, g->linear_count, sizeof(double));
+            g->value = _plan_alloc(n, g->linear_count, sizeof(double));
+            g->valid = _plan_alloc(n, g->linear_count, sizeof(double));
+        }
+        /* Linear items first, then items using library functions. */
+        fill[t] = g->linear_count;
+    }
+
+    /* Fill the group arrays (marshal_list order is kept within a group). */
+    for (MarshalItem* mi = n->marshal_list; mi && mi->signal; mi++) {
+        NetworkSignal*  ns = mi->signal;
+        NetworkMessage* nm = mi->message;
+        if (ns->type == NETWORK_SIGNAL_TYPE_UNKNOWN ||
+            ns->type >= NETWORK_SIGNAL_TYPE__COUNT) {
+            continue;
+        }
+        MarshalGroup* g = &plan->group[ns->type];
+        size_t        i;
+        if (network_signal_linear(ns)) {
+            i = fill_linear[ns->type]++;
+            _plan_set_linear(g, i, ns);
+        } else {
+            i = fill[ns->type]++;
+        }
+        mi->plan_index = i;
+        g->data[i] = (uint8_t*)nm->buffer + ns->buffer_offset;
+        g->index[i] = mi->signal_vector_index;
+        g->update[i] = &nm->update_signals;
+        if (ns->internal && nm->container) {
+            /* Internal signals on container messages take a constant value. */
+            g->constant[i] = &ns->value;
+        }
+        _plan_set_funcs(g, i, ns);
+    }
+
+    /* Message slices (of the groups). */
+    size_t slice_count = 0;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        slice_count += _load_marshal_slices(plan, nm, NULL);
+    }
+    MarshalSlice* slices = _plan_alloc(n, slice_count, sizeof(MarshalSlice));
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        nm->marshal_slices = slices;
+        nm->marshal_slice_count = _load_marshal_slices(plan, nm, slices);
+        slices += nm->marshal_slice_count;
+    }
+
+    /* Signal dependency map and changed bitmap. */
+    plan->signal_item = _plan_alloc(n, n->signal_count, sizeof(MarshalItem*));
+    plan->signal_changed =
+        _plan_alloc(n, (n->signal_count + 63) / 64, sizeof(uint64_t));
+    for (MarshalItem* mi = n->marshal_list; mi && mi->signal; mi++) {
+        if (mi->signal_vector_index >= n->signal_count) continue;
+        plan->signal_item[mi->signal_vector_index] = mi;
+    }
+
+    /* Fused marshal functions (index in the order of the function). */
+    plan->marshal_index =
+        _plan_alloc(n, n->signal_count + 1, sizeof(uint32_t));
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        nm->marshal_index = NULL;
+        if (nm->marshal_tx == NULL || nm->marshal_rx == NULL) continue;
+        if (nm->marshal_signals == NULL || nm->marshal_count == 0) continue;
+        uint32_t* index = plan->marshal_index +
+                          (nm->marshal_items - n->marshal_list);
+        if (_load_marshal_index(nm, index)) {
+            nm->marshal_index = index;
+            log_debug("Fused marshal functions: %s", nm->name);
         }
     }
+
+    n->marshal_plan = plan;
     return 0;
 }
 
 
-int network_marshal_messages_to_signals(
-    Network* n, MarshalItem* marshal_list, bool single)
+static void _marshal_signal_to_message(Network* n, MarshalItem* mi)
+{
+    NetworkSignalType type = mi->signal->type;
+    if (n->marshal_plan && type != NETWORK_SIGNAL_TYPE_UNKNOWN) {
+        /* Item of the plan (linear codec or library functions). */
+        MarshalGroup* g = &n->marshal_plan->group[type];
+        __plan_encode_kernel[type](n, g, mi->plan_index, mi->plan_index + 1);
+        return;
+    }
+    double _signal_value = n->signal_vector[mi->signal_vector_index];
+    if (mi->signal->internal && mi->message->container) {
+        /* Internal signals on container messages take a constant value. */
+        _signal_value = mi->signal->value;
+    }
+    __encode_kernel[mi->signal->type](mi, _signal_value);
+}
+
+
+int network_marshal_signals_to_messages(Network* n, MarshalItem* marshal_list)
 {
     if (n == NULL || marshal_list == NULL) return 1;
+    if (marshal_list == n->marshal_list && n->marshal_plan) {
+        /* Full list, use the compiled plan. */
+        for (size_t t = 0; t < NETWORK_SIGNAL_TYPE__COUNT; t++) {
+            MarshalGroup* g = &n->marshal_plan->group[t];
+            if (g->count) __plan_encode_kernel[t](n, g, 0, g->count);
+        }
+        return 0;
+    }
     for (MarshalItem* mi = marshal_list; mi && mi->signal; mi++) {
-        log_debug(
-            "MI Signal: frame_id=%d, update_signals=%d, index=%d, type=%s",
-            mi->message->frame_id, mi->message->update_signals,
-            mi->signal_vector_index, mi->signal->member_type);
-        if (mi->message->update_signals == false && single == false) {
-            /* Next item (will be forced if single == true). */
-            continue;
+        _marshal_signal_to_message(n, mi);
+    }
+    return 0;
+}
+
+
+/* Mark a signal (by signal vector index) as changed, the signal will be
+marshalled by the next call to network_marshal_changed_signals(). */
+void network_signal_changed(Network* n, size_t index)
+{
+    if (n == NULL || n->marshal_plan == NULL) return;
+    if (index >= n->signal_count) return;
+    n->marshal_plan->signal_changed[index / 64] |= (1ULL << (index % 64));
+}
+
+
+/* Mark all signals of a message as changed, used when the message buffer
+was written by unpack_func() (RX or message functions) so that the next TX
+restores the buffer from the signal vector (as a full marshal would). */
+void network_message_changed(Network* n, NetworkMessage* nm)
+{
+    if (n == NULL || n->marshal_plan == NULL || nm == NULL) return;
+    for (size_t i = 0; i < nm->marshal_count; i++) {
+        network_signal_changed(n, nm->marshal_items[i].signal_vector_index);
+    }
+}
+
+
+/* Marshal all signals of a message to the message buffer (without marking
+the message for pack or TX). */
+void network_marshal_message(Network* n, NetworkMessage* nm)
+{
+    if (n == NULL || nm == NULL) return;
+    if (nm->marshal_index) {
+        nm->marshal_tx(n->signal_vector, nm->marshal_index, nm->buffer);
+        return;
+    }
+    for (size_t i = 0; i < nm->marshal_count; i++) {
+        _marshal_signal_to_message(n, &nm->marshal_items[i]);
+    }
+}
+
+
+int network_marshal_changed_signals(Network* n)
+{
+    if (n == NULL || n->marshal_list == NULL) return 1;
+    MarshalPlan* plan = n->marshal_plan;
+    if (plan == NULL) {
+        /* No plan, marshal all signals and pack all messages. */
+        network_marshal_signals_to_messages(n, n->marshal_list);
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            nm->needs_pack = true;
         }
-        if (strcmp(mi->signal->member_type, "uint8_t") == 0) {
-            if (mi->signal->range_func_int8(
-                    ((int8_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int8_t)])) {
-                double _v = mi->signal->decode_func_int8(
-                    ((int8_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int8_t)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((uint8_t*)
-                            mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                 sizeof(uint8_t)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "uint16_t") == 0) {
-            if (mi->signal->range_func_int16((
-                    (int16_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int16_t)])) {
-                double _v = mi->signal->decode_func_int16((
-                    (int16_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int16_t)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((uint16_t*)
-                            mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                 sizeof(uint16_t)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "uint32_t") == 0) {
-            if (mi->signal->range_func_int32((
-                    (int32_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int32_t)])) {
-                double _v = mi->signal->decode_func_int32((
-                    (int32_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int32_t)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((uint32_t*)
-                            mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                 sizeof(uint32_t)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "uint64_t") == 0) {
-            if (mi->signal->range_func_int64((
-                    (int64_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int64_t)])) {
-                double _v = mi->signal->decode_func_int64((
-                    (int64_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int64_t)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((uint64_t*)
-                            mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                 sizeof(uint64_t)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "int8_t") == 0) {
-            if (mi->signal->range_func_int8(
-                    ((int8_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int8_t)])) {
-                double _v = mi->signal->decode_func_int8(
-                    ((int8_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int8_t)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((int8_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int8_t)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "int16_t") == 0) {
-            if (mi->signal->range_func_int16((
-                    (int16_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int16_t)])) {
-                double _v = mi->signal->decode_func_int16((
-                    (int16_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int16_t)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((int16_t*)
-                            mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                 sizeof(int16_t)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "int32_t") == 0) {
-            if (mi->signal->range_func_int32((
-                    (int32_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int32_t)])) {
-                double _v = mi->signal->decode_func_int32((
-                    (int32_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int32_t)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((int32_t*)
-                            mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                 sizeof(int32_t)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "int64_t") == 0) {
-            if (mi->signal->range_func_int64((
-                    (int64_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int64_t)])) {
-                double _v = mi->signal->decode_func_int64((
-                    (int64_t*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(int64_t)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((int64_t*)
-                            mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                 sizeof(int64_t)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
-            }
-        } else if (strcmp(mi->signal->member_type, "float") == 0) {
-            if (mi->signal->range_func_float(
-                    ((float*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                  sizeof(float)])) {
-                double _v = mi->signal->decode_func_float(((float*)mi->message
-                        ->buffer)[(mi->signal->buffer_offset) / sizeof(float)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((float*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                  sizeof(float)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
+        return 0;
+    }
+
+    size_t words = (n->signal_count + 63) / 64;
+    for (size_t w = 0; w < words; w++) {
+        while (plan->signal_changed[w]) {
+            uint64_t bits = plan->signal_changed[w];
+            size_t   index = (w * 64) + __builtin_ctzll(bits);
+            plan->signal_changed[w] = bits & (bits - 1);
+            MarshalItem* mi = plan->signal_item[index];
+            if (mi == NULL) continue;
+            NetworkMessage* nm = mi->message;
+            nm->needs_pack = true;
+            if (nm->marshal_index == NULL) {
+                _marshal_signal_to_message(n, mi);
+                continue;
             }
-        } else if (strcmp(mi->signal->member_type, "double") == 0) {
-            if (mi->signal->range_func_double(
-                    ((double*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(double)])) {
-                double _v = mi->signal->decode_func_double(
-                    ((double*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(double)]);
-                n->signal_vector[mi->signal_vector_index] = _v;
-
-                log_debug("calling decode_func (%d -> %f): %f %s",
-                    ((double*)mi->message->buffer)[(mi->signal->buffer_offset) /
-                                                   sizeof(double)],
-                    _v, n->signal_vector[mi->signal_vector_index],
-                    mi->signal->name);
+            /* Fused, marshal all signals of the message (once). */
+            nm->marshal_tx(n->signal_vector, nm->marshal_index, nm->buffer);
+            size_t end =
+                nm->marshal_items[0].signal_vector_index + nm->marshal_count;
+            for (size_t i = index + 1; i < end; i++) {
+                plan->signal_changed[i / 64] &= ~(1ULL << (i % 64));
             }
-        } else {
-            log_error("Unknown type: %s (frame_id=%d, message=%s, signal=%s)",
-                mi->signal->member_type, mi->message->frame_id,
-                mi->message->name, mi->signal->name);
         }
+    }
+    return 0;
+}
 
-        /* When single is true, process the single MI _ONLY_. */
-        if (single) return 0;
+
+static void _marshal_message_to_signal(Network* n, MarshalItem* mi)
+{
+    NetworkSignalType type = mi->signal->type;
+    if (n->marshal_plan && type != NETWORK_SIGNAL_TYPE_UNKNOWN) {
+        /* Item of the plan (linear codec or library functions). */
+        MarshalGroup* g = &n->marshal_plan->group[type];
+        __plan_decode_kernel[type](
+            n, g, mi->plan_index, mi->plan_index + 1, true);
+        return;
+    }
+    __decode_kernel[type](n, mi);
+}
+
+
+int network_marshal_messages_to_signals(
+    Network* n, MarshalItem* marshal_list, bool single)
+{
+    if (n == NULL || marshal_list == NULL) return 1;
+    if (marshal_list == n->marshal_list && n->marshal_plan && single == false) {
+        /* Full list, use the compiled plan. */
+        for (size_t t = 0; t < NETWORK_SIGNAL_TYPE__COUNT; t++) {
+            MarshalGroup* g = &n->marshal_plan->group[t];
+            if (g->count) __plan_decode_kernel[t](n, g, 0, g->count, false);
+        }
+    } else {
+        for (MarshalItem* mi = marshal_list; mi && mi->signal; mi++) {
+            log_debug(
+                "MI Signal: frame_id=%d, update_signals=%d, index=%d, type=%s",
+                mi->message->frame_id, mi->message->update_signals,
+                mi->signal_vector_index, mi->info->member_type);
+            if (mi->message->update_signals == false && single == false) {
+                /* Next item (will be forced if single == true). */
+                continue;
+            }
+            _marshal_message_to_signal(n, mi);
+
+            /* When single is true, process the single MI _ONLY_. */
+            if (single) return 0;
+        }
     }
 
     /* Reset the message processing flags. */
     for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
         nm->update_signals = false;
+        nm->update_queued = false;
+    }
+    n->update_count = 0;
+
+    return 0;
+}
+
+
+/* Set update_signals on a message and queue the message for decode by the
+next call to network_marshal_updated_messages(). */
+void network_message_update(Network* n, NetworkMessage* nm)
+{
+    if (n == NULL || nm == NULL) return;
+    nm->update_signals = true;
+    if (nm->update_queued || n->update_list == NULL) return;
+    nm->update_queued = true;
+    n->update_list[n->update_count++] = nm;
+}
+
+
+/* Decode the signals of queued messages (cost scales with the received
+traffic rather than the size of the network). Messages which were queued but
+have since had update_signals reset (e.g. by a decode function) are skipped. */
+int network_marshal_updated_messages(Network* n)
+{
+    if (n == NULL || n->marshal_list == NULL) return 1;
+    if (n->update_list == NULL) {
+        return network_marshal_messages_to_signals(n, n->marshal_list, false);
+    }
+
+    for (size_t i = 0; i < n->update_count; i++) {
+        NetworkMessage* nm = n->update_list[i];
+        if (nm->update_signals && nm->marshal_index) {
+            nm->marshal_rx(n->signal_vector, nm->marshal_index, nm->buffer);
+        } else if (nm->update_signals && n->marshal_plan) {
+            /* Slices of the plan (linear codec or library functions). */
+            for (size_t j = 0; j < nm->marshal_slice_count; j++) {
+                MarshalSlice* s = &nm->marshal_slices[j];
+                __plan_decode_kernel[s->type](n,
+                    &n->marshal_plan->group[s->type], s->begin, s->end, true);
+            }
+        } else if (nm->update_signals) {
+            for (size_t j = 0; j < nm->marshal_count; j++) {
+                MarshalItem* mi = &nm->marshal_items[j];
+                __decode_kernel[mi->signal->type](n, mi);
+            }
+        }
+        nm->update_signals = false;
+        nm->update_queued = false;
     }
+    n->update_count = 0;
 
     return 0;
 }
 
 
+static void _pack_message(Network* n, NetworkMessage* nm)
+{
+    nm->needs_pack = false;
+    if (nm->pack_func == NULL) return;
+
+    nm->pack_func(nm->payload, nm->buffer, nm->payload_len);
+
+    /* Check if the buffer changed (since the last RX/TX). Periodic messages
+    only TX on the cycle, other messages TX on change (subject to the MDT),
+    or when a repetition or deferred TX is made by the schedule. */
+    bool periodic = (network_tx_mode(nm) == NETWORK_TX_MODE_PERIODIC);
+    if (network_message_buffer_changed(nm)) {
+        if (periodic == false) {
+            log_debug("encode path buffer changed (frame_id=%d)", nm->frame_id);
+            network_message_buffer_commit(nm);
+            network_schedule_tx(n, nm);
+        }
+    } else if (periodic || nm->schedule_item == NULL ||
+               nm->schedule_item->tx_events == false) {
+        nm->needs_tx = false;
+    }
+}
+
+
 void network_pack_messages(Network* n)
 {
     assert(n);
 
     /* Loop over messages and call pack_func. */
     for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
-        if (nm->pack_func) {
-            nm->pack_func(nm->payload, nm->buffer, nm->payload_len);
-
-            /* Calculate checksum for the current buffer. */
-            uint32_t payload_checksum =
-                simbus_generate_uid_hash((uint8_t*)nm->buffer, nm->buffer_len);
-
-            /* Check if the payload_checksum is different. */
-            if (payload_checksum != nm->buffer_checksum) {
-                if (nm->cycle_time_ms) {
-                } else {
-                    nm->needs_tx = true;
-                    log_debug("encode path checksum %u", payload_checksum);
-                    nm->buffer_checksum = payload_checksum;
-                }
-            } else {
-                nm->needs_tx = false;
-            }
-        }
+        _pack_message(n, nm);
+    }
+}
+
+
+void network_pack_changed_messages(Network* n)
+{
+    assert(n);
+
+    /* Pack messages with changed signals, or which are scheduled for TX. */
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        if (nm->needs_pack == false && nm->needs_tx == false) continue;
+        _pack_message(n, nm);
     }
 }
 
@@ -488,9 +1002,26 @@ void network_unpack_messages(Network* n)
 
 int network_unload_marshal_lists(Network* n)
 {
+    /* The lists are held by the arena. */
     if (n) {
-        if (n->marshal_list) free(n->marshal_list);
+        network_unload_marshal_plan(n);
+        n->marshal_list = NULL;
+        n->update_list = NULL;
+        n->update_count = 0;
+        n->frame_index = NULL;
+        n->frame_index_size = 0;
+        n->mux_index = NULL;
     }
 
     return 0;
 }
+
+
+int network_unload_marshal_plan(Network* n)
+{
+    /* The plan is held by the arena. */
+    if (n == NULL) return 0;
+    n->marshal_plan = NULL;
+
+    return 0;
+}
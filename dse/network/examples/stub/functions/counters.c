@@ -22,6 +22,8 @@ Increment an 8-bit counter in the message packet.
 the corresponding signal. Subsequent calls to `network_message_recalculate`
 may overwrite the modified counter.
 
+The modification is reported with `network_function_modified`.
+
 Parameters
 ----------
 data (void**)
@@ -71,6 +73,7 @@ int counter_inc_uint8(
     uint8_t  counter = buffer[inst->position];
     counter++;
     buffer[inst->position] = counter;
+    network_function_modified(function);
 
     return 0;
 }
@@ -19,7 +19,8 @@ specified position in the message packet.
 The CRC algorithm is a simple summation of all bytes in the message packet.
 
 > Note: in the encode path (TX), changes to the counter are not reflected in
-the corresponding signal.
+the corresponding signal. Changes to the CRC are reported with
+`network_function_modified`.
 
 Parameters
 ----------
@@ -69,7 +70,10 @@ int crc_generate(
         if (i == inst->position) continue;
         crc += buffer[i];
     }
-    buffer[inst->position] = crc;
+    if (buffer[inst->position] != crc) {
+        buffer[inst->position] = crc;
+        network_function_modified(function);
+    }
 
     return 0;
 }
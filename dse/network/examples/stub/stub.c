@@ -981,3 +981,355 @@ bool stub_mux_message_bar_float_is_in_range(float value)
 
     return (true);
 }
+
+/* Fused marshal functions (generated by gencode.py). */
+
+const char* stub_example_message_marshal_signals[] = {
+    "enable",
+    "average_radius",
+    "temperature",
+    NULL,
+};
+
+void stub_example_message_marshal_tx(
+    const double* sv, const uint32_t* idx, void* buffer)
+{
+    struct stub_example_message_t* msg_p = buffer;
+    {
+        uint8_t value = stub_example_message_enable_encode(sv[idx[0]]);
+        if (stub_example_message_enable_is_in_range(value)) msg_p->enable = value;
+    }
+    {
+        uint8_t value = stub_example_message_average_radius_encode(sv[idx[1]]);
+        if (stub_example_message_average_radius_is_in_range(value)) msg_p->average_radius = value;
+    }
+    {
+        int16_t value = stub_example_message_temperature_encode(sv[idx[2]]);
+        if (stub_example_message_temperature_is_in_range(value)) msg_p->temperature = value;
+    }
+}
+
+void stub_example_message_marshal_rx(
+    double* sv, const uint32_t* idx, const void* buffer)
+{
+    const struct stub_example_message_t* msg_p = buffer;
+    if (stub_example_message_enable_is_in_range(msg_p->enable)) {
+        sv[idx[0]] = stub_example_message_enable_decode(msg_p->enable);
+    }
+    if (stub_example_message_average_radius_is_in_range(msg_p->average_radius)) {
+        sv[idx[1]] = stub_example_message_average_radius_decode(msg_p->average_radius);
+    }
+    if (stub_example_message_temperature_is_in_range(msg_p->temperature)) {
+        sv[idx[2]] = stub_example_message_temperature_decode(msg_p->temperature);
+    }
+}
+
+const char* stub_example_message2_marshal_signals[] = {
+    "radius",
+    NULL,
+};
+
+void stub_example_message2_marshal_tx(
+    const double* sv, const uint32_t* idx, void* buffer)
+{
+    struct stub_example_message2_t* msg_p = buffer;
+    {
+        uint8_t value = stub_example_message2_radius_encode(sv[idx[0]]);
+        if (stub_example_message2_radius_is_in_range(value)) msg_p->radius = value;
+    }
+}
+
+void stub_example_message2_marshal_rx(
+    double* sv, const uint32_t* idx, const void* buffer)
+{
+    const struct stub_example_message2_t* msg_p = buffer;
+    if (stub_example_message2_radius_is_in_range(msg_p->radius)) {
+        sv[idx[0]] = stub_example_message2_radius_decode(msg_p->radius);
+    }
+}
+
+const char* stub_function_example_marshal_signals[] = {
+    "crc",
+    "alive",
+    "foo",
+    "bar",
+    NULL,
+};
+
+void stub_function_example_marshal_tx(
+    const double* sv, const uint32_t* idx, void* buffer)
+{
+    struct stub_function_example_t* msg_p = buffer;
+    {
+        uint8_t value = stub_function_example_crc_encode(sv[idx[0]]);
+        if (stub_function_example_crc_is_in_range(value)) msg_p->crc = value;
+    }
+    {
+        uint8_t value = stub_function_example_alive_encode(sv[idx[1]]);
+        if (stub_function_example_alive_is_in_range(value)) msg_p->alive = value;
+    }
+    {
+        uint8_t value = stub_function_example_foo_encode(sv[idx[2]]);
+        if (stub_function_example_foo_is_in_range(value)) msg_p->foo = value;
+    }
+    {
+        uint8_t value = stub_function_example_bar_encode(sv[idx[3]]);
+        if (stub_function_example_bar_is_in_range(value)) msg_p->bar = value;
+    }
+}
+
+void stub_function_example_marshal_rx(
+    double* sv, const uint32_t* idx, const void* buffer)
+{
+    const struct stub_function_example_t* msg_p = buffer;
+    if (stub_function_example_crc_is_in_range(msg_p->crc)) {
+        sv[idx[0]] = stub_function_example_crc_decode(msg_p->crc);
+    }
+    if (stub_function_example_alive_is_in_range(msg_p->alive)) {
+        sv[idx[1]] = stub_function_example_alive_decode(msg_p->alive);
+    }
+    if (stub_function_example_foo_is_in_range(msg_p->foo)) {
+        sv[idx[2]] = stub_function_example_foo_decode(msg_p->foo);
+    }
+    if (stub_function_example_bar_is_in_range(msg_p->bar)) {
+        sv[idx[3]] = stub_function_example_bar_decode(msg_p->bar);
+    }
+}
+
+const char* stub_unsigned_types_marshal_signals[] = {
+    "u_int8_signal",
+    "u_int16_signal",
+    "u_int32_signal",
+    "u_int64_signal",
+    NULL,
+};
+
+void stub_unsigned_types_marshal_tx(
+    const double* sv, const uint32_t* idx, void* buffer)
+{
+    struct stub_unsigned_types_t* msg_p = buffer;
+    {
+        uint8_t value = stub_unsigned_types_u_int8_signal_encode(sv[idx[0]]);
+        if (stub_unsigned_types_u_int8_signal_is_in_range(value)) msg_p->u_int8_signal = value;
+    }
+    {
+        uint16_t value = stub_unsigned_types_u_int16_signal_encode(sv[idx[1]]);
+        if (stub_unsigned_types_u_int16_signal_is_in_range(value)) msg_p->u_int16_signal = value;
+    }
+    {
+        uint32_t value = stub_unsigned_types_u_int32_signal_encode(sv[idx[2]]);
+        if (stub_unsigned_types_u_int32_signal_is_in_range(value)) msg_p->u_int32_signal = value;
+    }
+    {
+        uint64_t value = stub_unsigned_types_u_int64_signal_encode(sv[idx[3]]);
+        if (stub_unsigned_types_u_int64_signal_is_in_range(value)) msg_p->u_int64_signal = value;
+    }
+}
+
+void stub_unsigned_types_marshal_rx(
+    double* sv, const uint32_t* idx, const void* buffer)
+{
+    const struct stub_unsigned_types_t* msg_p = buffer;
+    if (stub_unsigned_types_u_int8_signal_is_in_range(msg_p->u_int8_signal)) {
+        sv[idx[0]] = stub_unsigned_types_u_int8_signal_decode(msg_p->u_int8_signal);
+    }
+    if (stub_unsigned_types_u_int16_signal_is_in_range(msg_p->u_int16_signal)) {
+        sv[idx[1]] = stub_unsigned_types_u_int16_signal_decode(msg_p->u_int16_signal);
+    }
+    if (stub_unsigned_types_u_int32_signal_is_in_range(msg_p->u_int32_signal)) {
+        sv[idx[2]] = stub_unsigned_types_u_int32_signal_decode(msg_p->u_int32_signal);
+    }
+    if (stub_unsigned_types_u_int64_signal_is_in_range(msg_p->u_int64_signal)) {
+        sv[idx[3]] = stub_unsigned_types_u_int64_signal_decode(msg_p->u_int64_signal);
+    }
+}
+
+const char* stub_signed_types_marshal_signals[] = {
+    "int8_signal",
+    "int16_signal",
+    "int32_signal",
+    "int64_signal",
+    NULL,
+};
+
+void stub_signed_types_marshal_tx(
+    const double* sv, const uint32_t* idx, void* buffer)
+{
+    struct stub_signed_types_t* msg_p = buffer;
+    {
+        int8_t value = stub_signed_types_int8_signal_encode(sv[idx[0]]);
+        if (stub_signed_types_int8_signal_is_in_range(value)) msg_p->int8_signal = value;
+    }
+    {
+        int16_t value = stub_signed_types_int16_signal_encode(sv[idx[1]]);
+        if (stub_signed_types_int16_signal_is_in_range(value)) msg_p->int16_signal = value;
+    }
+    {
+        int32_t value = stub_signed_types_int32_signal_encode(sv[idx[2]]);
+        if (stub_signed_types_int32_signal_is_in_range(value)) msg_p->int32_signal = value;
+    }
+    {
+        int64_t value = stub_signed_types_int64_signal_encode(sv[idx[3]]);
+        if (stub_signed_types_int64_signal_is_in_range(value)) msg_p->int64_signal = value;
+    }
+}
+
+void stub_signed_types_marshal_rx(
+    double* sv, const uint32_t* idx, const void* buffer)
+{
+    const struct stub_signed_types_t* msg_p = buffer;
+    if (stub_signed_types_int8_signal_is_in_range(msg_p->int8_signal)) {
+        sv[idx[0]] = stub_signed_types_int8_signal_decode(msg_p->int8_signal);
+    }
+    if (stub_signed_types_int16_signal_is_in_range(msg_p->int16_signal)) {
+        sv[idx[1]] = stub_signed_types_int16_signal_decode(msg_p->int16_signal);
+    }
+    if (stub_signed_types_int32_signal_is_in_range(msg_p->int32_signal)) {
+        sv[idx[2]] = stub_signed_types_int32_signal_decode(msg_p->int32_signal);
+    }
+    if (stub_signed_types_int64_signal_is_in_range(msg_p->int64_signal)) {
+        sv[idx[3]] = stub_signed_types_int64_signal_decode(msg_p->int64_signal);
+    }
+}
+
+const char* stub_float_types_marshal_signals[] = {
+    "double_signal",
+    "float_signal",
+    NULL,
+};
+
+void stub_float_types_marshal_tx(
+    const double* sv, const uint32_t* idx, void* buffer)
+{
+    struct stub_float_types_t* msg_p = buffer;
+    {
+        double value = stub_float_types_double_signal_encode(sv[idx[0]]);
+        if (stub_float_types_double_signal_is_in_range(value)) msg_p->double_signal = value;
+    }
+    {
+        float value = stub_float_types_float_signal_encode(sv[idx[1]]);
+        if (stub_float_types_float_signal_is_in_range(value)) msg_p->float_signal = value;
+    }
+}
+
+void stub_float_types_marshal_rx(
+    double* sv, const uint32_t* idx, const void* buffer)
+{
+    const struct stub_float_types_t* msg_p = buffer;
+    if (stub_float_types_double_signal_is_in_range(msg_p->double_signal)) {
+        sv[idx[0]] = stub_float_types_double_signal_decode(msg_p->double_signal);
+    }
+    if (stub_float_types_float_signal_is_in_range(msg_p->float_signal)) {
+        sv[idx[1]] = stub_float_types_float_signal_decode(msg_p->float_signal);
+    }
+}
+
+const char* stub_scheduled_message_marshal_signals[] = {
+    "schedule_signal",
+    NULL,
+};
+
+void stub_scheduled_message_marshal_tx(
+    const double* sv, const uint32_t* idx, void* buffer)
+{
+    struct stub_scheduled_message_t* msg_p = buffer;
+    {
+        uint8_t value = stub_scheduled_message_schedule_signal_encode(sv[idx[0]]);
+        if (stub_scheduled_message_schedule_signal_is_in_range(value)) msg_p->schedule_signal = value;
+    }
+}
+
+void stub_scheduled_message_marshal_rx(
+    double* sv, const uint32_t* idx, const void* buffer)
+{
+    const struct stub_scheduled_message_t* msg_p = buffer;
+    if (stub_scheduled_message_schedule_signal_is_in_range(msg_p->schedule_signal)) {
+        sv[idx[0]] = stub_scheduled_message_schedule_signal_decode(msg_p->schedule_signal);
+    }
+}
+
+/* Network descriptor (generated by gencode.py). */
+
+struct stub_signal_descriptor {
+    const char* name;
+    void*       encode;
+    void*       decode;
+    void*       range;
+};
+
+struct stub_message_descriptor {
+    const char*  name;
+    void*        pack;
+    void*        unpack;
+    const struct stub_signal_descriptor* signals;
+    const char** marshal_signals;
+    void*        marshal_tx;
+    void*        marshal_rx;
+};
+
+static const struct stub_signal_descriptor stub_example_message_signal_descriptor[] = {
+    { "enable", (void*)stub_example_message_enable_encode, (void*)stub_example_message_enable_decode, (void*)stub_example_message_enable_is_in_range },
+    { "average_radius", (void*)stub_example_message_average_radius_encode, (void*)stub_example_message_average_radius_decode, (void*)stub_example_message_average_radius_is_in_range },
+    { "temperature", (void*)stub_example_message_temperature_encode, (void*)stub_example_message_temperature_decode, (void*)stub_example_message_temperature_is_in_range },
+    { NULL },
+};
+
+static const struct stub_signal_descriptor stub_example_message2_signal_descriptor[] = {
+    { "radius", (void*)stub_example_message2_radius_encode, (void*)stub_example_message2_radius_decode, (void*)stub_example_message2_radius_is_in_range },
+    { NULL },
+};
+
+static const struct stub_signal_descriptor stub_function_example_signal_descriptor[] = {
+    { "crc", (void*)stub_function_example_crc_encode, (void*)stub_function_example_crc_decode, (void*)stub_function_example_crc_is_in_range },
+    { "alive", (void*)stub_function_example_alive_encode, (void*)stub_function_example_alive_decode, (void*)stub_function_example_alive_is_in_range },
+    { "foo", (void*)stub_function_example_foo_encode, (void*)stub_function_example_foo_decode, (void*)stub_function_example_foo_is_in_range },
+    { "bar", (void*)stub_function_example_bar_encode, (void*)stub_function_example_bar_decode, (void*)stub_function_example_bar_is_in_range },
+    { NULL },
+};
+
+static const struct stub_signal_descriptor stub_unsigned_types_signal_descriptor[] = {
+    { "u_int8_signal", (void*)stub_unsigned_types_u_int8_signal_encode, (void*)stub_unsigned_types_u_int8_signal_decode, (void*)stub_unsigned_types_u_int8_signal_is_in_range },
+    { "u_int16_signal", (void*)stub_unsigned_types_u_int16_signal_encode, (void*)stub_unsigned_types_u_int16_signal_decode, (void*)stub_unsigned_types_u_int16_signal_is_in_range },
+    { "u_int32_signal", (void*)stub_unsigned_types_u_int32_signal_encode, (void*)stub_unsigned_types_u_int32_signal_decode, (void*)stub_unsigned_types_u_int32_signal_is_in_range },
+    { "u_int64_signal", (void*)stub_unsigned_types_u_int64_signal_encode, (void*)stub_unsigned_types_u_int64_signal_decode, (void*)stub_unsigned_types_u_int64_signal_is_in_range },
+    { NULL },
+};
+
+static const struct stub_signal_descriptor stub_signed_types_signal_descriptor[] = {
+    { "int8_signal", (void*)stub_signed_types_int8_signal_encode, (void*)stub_signed_types_int8_signal_decode, (void*)stub_signed_types_int8_signal_is_in_range },
+    { "int16_signal", (void*)stub_signed_types_int16_signal_encode, (void*)stub_signed_types_int16_signal_decode, (void*)stub_signed_types_int16_signal_is_in_range },
+    { "int32_signal", (void*)stub_signed_types_int32_signal_encode, (void*)stub_signed_types_int32_signal_decode, (void*)stub_signed_types_int32_signal_is_in_range },
+    { "int64_signal", (void*)stub_signed_types_int64_signal_encode, (void*)stub_signed_types_int64_signal_decode, (void*)stub_signed_types_int64_signal_is_in_range },
+    { NULL },
+};
+
+static const struct stub_signal_descriptor stub_float_types_signal_descriptor[] = {
+    { "double_signal", (void*)stub_float_types_double_signal_encode, (void*)stub_float_types_double_signal_decode, (void*)stub_float_types_double_signal_is_in_range },
+    { "float_signal", (void*)stub_float_types_float_signal_encode, (void*)stub_float_types_float_signal_decode, (void*)stub_float_types_float_signal_is_in_range },
+    { NULL },
+};
+
+static const struct stub_signal_descriptor stub_scheduled_message_signal_descriptor[] = {
+    { "schedule_signal", (void*)stub_scheduled_message_schedule_signal_encode, (void*)stub_scheduled_message_schedule_signal_decode, (void*)stub_scheduled_message_schedule_signal_is_in_range },
+    { NULL },
+};
+
+static const struct stub_signal_descriptor stub_mux_message_signal_descriptor[] = {
+    { "header_id", (void*)stub_mux_message_header_id_encode, (void*)stub_mux_message_header_id_decode, (void*)stub_mux_message_header_id_is_in_range },
+    { "header_dlc", (void*)stub_mux_message_header_dlc_encode, (void*)stub_mux_message_header_dlc_decode, (void*)stub_mux_message_header_dlc_is_in_range },
+    { "foo_double", (void*)stub_mux_message_foo_double_encode, (void*)stub_mux_message_foo_double_decode, (void*)stub_mux_message_foo_double_is_in_range },
+    { "bar_float", (void*)stub_mux_message_bar_float_encode, (void*)stub_mux_message_bar_float_decode, (void*)stub_mux_message_bar_float_is_in_range },
+    { NULL },
+};
+
+const struct stub_message_descriptor stub_network_descriptor[] = {
+    { "example_message", (void*)stub_example_message_pack, (void*)stub_example_message_unpack, stub_example_message_signal_descriptor, stub_example_message_marshal_signals, (void*)stub_example_message_marshal_tx, (void*)stub_example_message_marshal_rx },
+    { "example_message2", (void*)stub_example_message2_pack, (void*)stub_example_message2_unpack, stub_example_message2_signal_descriptor, stub_example_message2_marshal_signals, (void*)stub_example_message2_marshal_tx, (void*)stub_example_message2_marshal_rx },
+    { "function_example", (void*)stub_function_example_pack, (void*)stub_function_example_unpack, stub_function_example_signal_descriptor, stub_function_example_marshal_signals, (void*)stub_function_example_marshal_tx, (void*)stub_function_example_marshal_rx },
+    { "unsigned_types", (void*)stub_unsigned_types_pack, (void*)stub_unsigned_types_unpack, stub_unsigned_types_signal_descriptor, stub_unsigned_types_marshal_signals, (void*)stub_unsigned_types_marshal_tx, (void*)stub_unsigned_types_marshal_rx },
+    { "signed_types", (void*)stub_signed_types_pack, (void*)stub_signed_types_unpack, stub_signed_types_signal_descriptor, stub_signed_types_marshal_signals, (void*)stub_signed_types_marshal_tx, (void*)stub_signed_types_marshal_rx },
+    { "float_types", (void*)stub_float_types_pack, (void*)stub_float_types_unpack, stub_float_types_signal_descriptor, stub_float_types_marshal_signals, (void*)stub_float_types_marshal_tx, (void*)stub_float_types_marshal_rx },
+    { "scheduled_message", (void*)stub_scheduled_message_pack, (void*)stub_scheduled_message_unpack, stub_scheduled_message_signal_descriptor, stub_scheduled_message_marshal_signals, (void*)stub_scheduled_message_marshal_tx, (void*)stub_scheduled_message_marshal_rx },
+    { "mux_message", (void*)stub_mux_message_pack, (void*)stub_mux_message_unpack, stub_mux_message_signal_descriptor, NULL, NULL, NULL },
+    { NULL },
+};
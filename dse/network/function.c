@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
@@ -16,6 +18,16 @@ const char* network_function_annotation(NetworkFunction* nf, const char* name)
 }
 
 
+/* Called by a function when it changes the payload. A function which reports
+must report every change (the engine no longer compares the payload). */
+void network_function_modified(NetworkFunction* nf)
+{
+    if (nf == NULL) return;
+    nf->reports_modified = true;
+    nf->modified = true;
+}
+
+
 int network_function_apply_encode(Network* n)
 {
     assert(n);
@@ -27,27 +39,40 @@ int network_function_apply_encode(Network* n)
     for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
         if (net_off) nm->needs_tx = false;  // Force to false if network is off.
         if (nm->needs_tx == false) continue;
+        if (nm->encode_functions == NULL || nm->encode_functions->name == NULL)
+            continue;
 
-        uint32_t payload_checksum =
-            simbus_generate_uid_hash(nm->payload, nm->payload_len);
+        /* Shadow copy of the payload, only needed if a function does not
+        report modification (payload_len is uint8_t). */
+        uint8_t payload[UINT8_MAX];
+        bool    compare = false;
+        for (NetworkFunction* nf = nm->encode_functions; nf && nf->name; nf++) {
+            if (nf->reports_modified == false) compare = true;
+        }
+        if (compare) memcpy(payload, nm->payload, nm->payload_len);
 
+        bool modified = false;
         for (NetworkFunction* nf = nm->encode_functions; nf && nf->name; nf++) {
             if (nf->function) {
+                nf->modified = false;
                 int rc = nf->function(nf, nm->payload, nm->payload_len);
                 if (rc)
                     log_fatal("error from message function (rc=%d): %s:%s", rc,
                         nm->name, nf->name);
+                if (nf->modified) modified = true;
             }
         }
+        if (compare) {
+            modified = (memcmp(payload, nm->payload, nm->payload_len) != 0);
+        }
 
-        if (simbus_generate_uid_hash(nm->payload, nm->payload_len) !=
-            payload_checksum) {
+        if (modified) {
             /* Trigger update of signals based on changed payload. */
-            nm->update_signals = true;
+            network_message_update(n, nm);
             nm->unpack_func(nm->buffer, nm->payload, nm->payload_len);
-            /* Set the buffer checksum to prevent subsequent Tx. */
-            nm->buffer_checksum =
-                simbus_generate_uid_hash(nm->buffer, nm->buffer_len);
+            network_message_changed(n, nm);
+            /* Commit the buffer to prevent subsequent Tx. */
+            network_message_buffer_commit(nm);
         }
     }
 
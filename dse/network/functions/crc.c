@@ -0,0 +1,390 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+#include <dse/network/functions/crc.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC_CLMUL 1
+#include <immintrin.h>
+#endif
+
+
+typedef struct CrcAlgorithm CrcAlgorithm;
+typedef uint32_t (*CrcUpdateFunc)(
+    const CrcAlgorithm* a, uint32_t crc, const uint8_t* data, size_t len);
+
+typedef struct CrcAlgorithm {
+    /* Parameters (poly in normal representation). */
+    uint8_t       width;
+    uint32_t      poly;
+    uint32_t      init;
+    uint32_t      xorout;
+    bool          reflect;
+    /* Slice-by-8 tables, table[k] advances the CRC by k further bytes. */
+    uint32_t      table[8][256];
+    /* Folding constants (reflected, 32 bit CRCs): k1..k5, P' and mu. */
+    uint64_t      fold[7];
+    /* Update functions (by implementation, NULL if not supported). */
+    CrcUpdateFunc update[NETWORK_CRC_IMPL__COUNT];
+} CrcAlgorithm;
+
+
+static CrcAlgorithm __crc[NETWORK_CRC__COUNT] = {
+    [NETWORK_CRC8_SAE_J1850] = { 8, 0x1D, 0xFF, 0xFF, false },
+    [NETWORK_CRC8H2F] = { 8, 0x2F, 0xFF, 0xFF, false },
+    [NETWORK_CRC16_CCITT] = { 16, 0x1021, 0xFFFF, 0x0000, false },
+    [NETWORK_CRC32] = { 32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, true },
+    [NETWORK_CRC32P4] = { 32, 0xF4ACFB13, 0xFFFFFFFF, 0xFFFFFFFF, true },
+};
+
+
+static uint64_t _reflect(uint64_t value, unsigned bits)
+{
+    uint64_t r = 0;
+    for (unsigned i = 0; i < bits; i++) {
+        r = (r << 1) | (value & 1);
+        value >>= 1;
+    }
+    return r;
+}
+
+
+static uint32_t _mask(const CrcAlgorithm* a)
+{
+    return a->width == 32 ? 0xFFFFFFFF : (1u << a->width) - 1;
+}
+
+
+/* Table driven (slice-by-8). Reflected CRCs hold the register in the low
+bits, normal CRCs hold the register in the high bits (left aligned). */
+
+static uint32_t _table_update_reflect(
+    const CrcAlgorithm* a, uint32_t crc, const uint8_t* p, size_t len)
+{
+    const uint32_t(*t)[256] = a->table;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint32_t lo = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                                (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+              t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^ t[3][p[4]] ^
+              t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; len; p++, len--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+    }
+    return crc;
+}
+
+
+static uint32_t _table_update_normal(
+    const CrcAlgorithm* a, uint32_t crc, const uint8_t* p, size_t len)
+{
+    const uint32_t(*t)[256] = a->table;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint32_t hi = crc ^ ((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+                                (uint32_t)p[2] << 8 | (uint32_t)p[3]);
+        crc = t[7][hi >> 24] ^ t[6][(hi >> 16) & 0xFF] ^
+              t[5][(hi >> 8) & 0xFF] ^ t[4][hi & 0xFF] ^ t[3][p[4]] ^
+              t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; len; p++, len--) {
+        crc = (crc << 8) ^ t[0][(crc >> 24) ^ *p];
+    }
+    return crc;
+}
+
+
+static void _table_load(CrcAlgorithm* a)
+{
+    uint32_t poly = a->reflect ? (uint32_t)_reflect(a->poly, a->width)
+                               : a->poly << (32 - a->width);
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t r = a->reflect ? b : b << 24;
+        for (int i = 0; i < 8; i++) {
+            if (a->reflect) {
+                r = (r & 1) ? (r >> 1) ^ poly : r >> 1;
+            } else {
+                r = (r & 0x80000000) ? (r << 1) ^ poly : r << 1;
+            }
+        }
+        a->table[0][b] = r;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t r = a->table[k - 1][b];
+            a->table[k][b] = a->reflect
+                                 ? (r >> 8) ^ a->table[0][r & 0xFF]
+                                 : (r << 8) ^ a->table[0][r >> 24];
+        }
+    }
+}
+
+
+/* Carry-less multiply folding (Intel, "Fast CRC Computation for Generic
+Polynomials Using PCLMULQDQ Instruction"), reflected 32 bit CRCs. */
+
+static uint32_t _xn_mod_p(unsigned n, uint32_t poly)
+{
+    uint32_t r = 1;
+    for (unsigned i = 0; i < n; i++) {
+        r = (r & 0x80000000) ? (r << 1) ^ poly : r << 1;
+    }
+    return r;
+}
+
+
+static uint64_t _x64_div_p(uint32_t poly)
+{
+    uint64_t p = (1ULL << 32) | poly;
+    uint64_t r = 1ULL << 32;
+    uint64_t q = 0;
+    for (int i = 32; i >= 0; i--) {
+        if (r & (1ULL << 32)) {
+            q |= 1ULL << i;
+            r ^= p;
+        }
+        r <<= 1;
+    }
+    return q;
+}
+
+
+static void _fold_load(CrcAlgorithm* a)
+{
+    static const unsigned n[] = { 4 * 128 + 32, 4 * 128 - 32, 128 + 32,
+        128 - 32, 64 };
+    for (size_t i = 0; i < sizeof(n) / sizeof(n[0]); i++) {
+        a->fold[i] = _reflect(_xn_mod_p(n[i], a->poly), 32) << 1;
+    }
+    a->fold[5] = _reflect((1ULL << 32) | a->poly, 33);
+    a->fold[6] = _reflect(_x64_div_p(a->poly), 33);
+}
+
+
+#ifdef CRC_CLMUL
+
+__attribute__((target("pclmul,sse4.1"))) static uint32_t _clmul_fold(
+    const CrcAlgorithm* a, uint32_t crc, const uint8_t* p, size_t len)
+{
+    /* Fold 4x128 bits in parallel (len >= 64, multiple of 16). */
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+    x1 = _mm_loadu_si128((const __m128i*)(p + 0x00));
+    x2 = _mm_loadu_si128((const __m128i*)(p + 0x10));
+    x3 = _mm_loadu_si128((const __m128i*)(p + 0x20));
+    x4 = _mm_loadu_si128((const __m128i*)(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    x0 = _mm_set_epi64x((long long)a->fold[1], (long long)a->fold[0]);
+    for (p += 64, len -= 64; len >= 64; p += 64, len -= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+            _mm_loadu_si128((const __m128i*)(p + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+            _mm_loadu_si128((const __m128i*)(p + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+            _mm_loadu_si128((const __m128i*)(p + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+            _mm_loadu_si128((const __m128i*)(p + 0x30)));
+    }
+
+    /* Fold to 128 bits, then any remaining 128 bit blocks. */
+    x0 = _mm_set_epi64x((long long)a->fold[3], (long long)a->fold[2]);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+    for (; len >= 16; p += 16, len -= 16) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+            _mm_loadu_si128((const __m128i*)p));
+    }
+
+    /* Fold 128 bits to 64 bits. */
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x0 = _mm_set_epi64x(0, (long long)a->fold[4]);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, x3), x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits. */
+    x0 = _mm_set_epi64x((long long)a->fold[6], (long long)a->fold[5]);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, x3), x0, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, x3), x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+
+static uint32_t _clmul_update(
+    const CrcAlgorithm* a, uint32_t crc, const uint8_t* p, size_t len)
+{
+    if (len >= 64) {
+        size_t fold_len = len & ~(size_t)15;
+        crc = _clmul_fold(a, crc, p, fold_len);
+        p += fold_len;
+        len -= fold_len;
+    }
+    return _table_update_reflect(a, crc, p, len);
+}
+
+
+static bool _clmul_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+#else
+
+static bool _clmul_supported(void)
+{
+    return false;
+}
+
+#endif
+
+
+/* The tables are built, and the implementation selected, once when the
+library is loaded (the algorithms are then read only, and may be used by
+several network instances at the same time). */
+__attribute__((constructor)) static void _crc_setup(void)
+{
+    bool clmul = _clmul_supported();
+    for (size_t i = 0; i < NETWORK_CRC__COUNT; i++) {
+        CrcAlgorithm* a = &__crc[i];
+        _table_load(a);
+        CrcUpdateFunc table =
+            a->reflect ? _table_update_reflect : _table_update_normal;
+        a->update[NETWORK_CRC_IMPL_TABLE] = table;
+        a->update[NETWORK_CRC_IMPL_CLMUL] = clmul ? table : NULL;
+#ifdef CRC_CLMUL
+        if (clmul && a->reflect && a->width == 32) {
+            _fold_load(a);
+            a->update[NETWORK_CRC_IMPL_CLMUL] = _clmul_update;
+        }
+#endif
+        a->update[NETWORK_CRC_IMPL_AUTO] =
+            clmul ? a->update[NETWORK_CRC_IMPL_CLMUL] : table;
+    }
+}
+
+
+/**
+network_crc_supported
+=====================
+
+Indicate if a CRC implementation is supported (by this CPU). The fastest
+supported implementation is used by `network_crc_update` (and `network_crc`).
+
+Parameters
+----------
+impl (NetworkCrcImpl)
+: The implementation.
+
+Returns
+-------
+0
+: The implementation is supported.
+
+ENOTSUP
+: The implementation is not supported (by this CPU).
+*/
+int network_crc_supported(NetworkCrcImpl impl)
+{
+    if (impl >= NETWORK_CRC_IMPL__COUNT) return ENOTSUP;
+    return __crc[0].update[impl] ? 0 : ENOTSUP;
+}
+
+
+size_t network_crc_width(NetworkCrcType type)
+{
+    if (type >= NETWORK_CRC__COUNT) return 0;
+    return __crc[type].width / 8;
+}
+
+
+uint32_t network_crc_init(NetworkCrcType type)
+{
+    const CrcAlgorithm* a = &__crc[type];
+    if (a->reflect) return (uint32_t)_reflect(a->init, a->width);
+    return a->init << (32 - a->width);
+}
+
+
+uint32_t network_crc_update(
+    NetworkCrcType type, uint32_t crc, const uint8_t* data, size_t len)
+{
+    const CrcAlgorithm* a = &__crc[type];
+    return a->update[NETWORK_CRC_IMPL_AUTO](a, crc, data, len);
+}
+
+
+/* Update with a specific (supported) implementation, otherwise the table
+driven implementation is used. */
+uint32_t network_crc_update_impl(NetworkCrcImpl impl, NetworkCrcType type,
+    uint32_t crc, const uint8_t* data, size_t len)
+{
+    const CrcAlgorithm* a = &__crc[type];
+    CrcUpdateFunc       update = NULL;
+    if (impl < NETWORK_CRC_IMPL__COUNT) update = a->update[impl];
+    if (update == NULL) update = a->update[NETWORK_CRC_IMPL_TABLE];
+    return update(a, crc, data, len);
+}
+
+
+uint32_t network_crc_final(NetworkCrcType type, uint32_t crc)
+{
+    const CrcAlgorithm* a = &__crc[type];
+    if (a->reflect == false) crc >>= 32 - a->width;
+    return (crc ^ a->xorout) & _mask(a);
+}
+
+
+/**
+network_crc
+===========
+
+Calculate the CRC of a block of data.
+
+Parameters
+----------
+type (NetworkCrcType)
+: The CRC algorithm.
+
+data (const uint8_t*)
+: The data.
+
+len (size_t)
+: The length of the data.
+
+Returns
+-------
+uint32_t
+: The CRC value (width of the CRC algorithm).
+*/
+uint32_t network_crc(NetworkCrcType type, const uint8_t* data, size_t len)
+{
+    uint32_t crc = network_crc_init(type);
+    crc = network_crc_update(type, crc, data, len);
+    return network_crc_final(type, crc);
+}
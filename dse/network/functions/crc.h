@@ -0,0 +1,80 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef DSE_NETWORK_FUNCTIONS_CRC_H_
+#define DSE_NETWORK_FUNCTIONS_CRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+CRC Library
+===========
+
+CRC algorithms (AUTOSAR Crc library parameters) with table driven (slice-by-8)
+implementations and, where supported by the CPU, carry-less multiply (PCLMULQDQ)
+folding implementations. The fastest implementation supported by the CPU is
+selected once, when the library is loaded.
+
+A CRC is calculated either in one call (`network_crc`) or incrementally with
+`network_crc_init`, `network_crc_update` and `network_crc_final`. The
+intermediate value is an opaque register value.
+*/
+
+
+typedef enum NetworkCrcType {
+    NETWORK_CRC8_SAE_J1850 = 0, /* Poly 0x1D, init 0xFF, xor 0xFF. */
+    NETWORK_CRC8H2F,            /* Poly 0x2F, init 0xFF, xor 0xFF. */
+    NETWORK_CRC16_CCITT,        /* Poly 0x1021, init 0xFFFF, xor 0. */
+    NETWORK_CRC32,              /* Poly 0x04C11DB7, reflected (IEEE 802.3). */
+    NETWORK_CRC32P4,            /* Poly 0xF4ACFB13, reflected (E2E P4). */
+    NETWORK_CRC__COUNT,
+} NetworkCrcType;
+
+
+typedef enum NetworkCrcImpl {
+    NETWORK_CRC_IMPL_AUTO = 0, /* Fastest implementation supported. */
+    NETWORK_CRC_IMPL_TABLE,    /* Slice-by-8 tables. */
+    NETWORK_CRC_IMPL_CLMUL,    /* PCLMULQDQ folding (32 bit reflected CRCs). */
+    NETWORK_CRC_IMPL__COUNT,
+} NetworkCrcImpl;
+
+
+/* crc.c */
+size_t   network_crc_width(NetworkCrcType type);
+uint32_t network_crc_init(NetworkCrcType type);
+uint32_t network_crc_update(
+    NetworkCrcType type, uint32_t crc, const uint8_t* data, size_t len);
+uint32_t network_crc_final(NetworkCrcType type, uint32_t crc);
+uint32_t network_crc(NetworkCrcType type, const uint8_t* data, size_t len);
+int      network_crc_supported(NetworkCrcImpl impl);
+uint32_t network_crc_update_impl(NetworkCrcImpl impl, NetworkCrcType type,
+    uint32_t crc, const uint8_t* data, size_t len);
+
+/* crc_function.c (Network Functions) */
+struct NetworkFunction;
+int crc8_sae_j1850_generate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc8_sae_j1850_validate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc8h2f_generate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc8h2f_validate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc16_ccitt_generate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc16_ccitt_validate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc32_generate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc32_validate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc32p4_generate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+int crc32p4_validate(
+    struct NetworkFunction* function, uint8_t* payload, size_t payload_len);
+
+
+#endif  // DSE_NETWORK_FUNCTIONS_CRC_H_
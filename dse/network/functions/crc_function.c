@@ -0,0 +1,240 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <errno.h>
+#include <dse/testing.h>
+#include <dse/network/network.h>
+#include <dse/network/functions/crc.h>
+
+
+/**
+CRC Network Functions
+=====================
+
+Network Functions which generate (encode path, TX) and validate (decode path,
+RX) the CRC of a message packet. The CRC is calculated over all bytes of the
+message packet, excluding the CRC itself, and is stored in big-endian byte
+order at the specified position.
+
+| Generate                  | Validate                  | Algorithm       |
+| ------------------------- | ------------------------- | --------------- |
+| `crc8_sae_j1850_generate` | `crc8_sae_j1850_validate` | CRC8 SAE-J1850  |
+| `crc8h2f_generate`        | `crc8h2f_validate`        | CRC8H2F         |
+| `crc16_ccitt_generate`    | `crc16_ccitt_validate`    | CRC16 CCITT     |
+| `crc32_generate`          | `crc32_validate`          | CRC32 (IEEE)    |
+| `crc32p4_generate`        | `crc32p4_validate`        | CRC32P4 (E2E)   |
+
+> Note: in the encode path (TX), changes to the CRC are reported with
+`network_function_modified`. In the decode path (RX), bad messages (function
+returns EBADMSG) will not change corresponding signals.
+
+Parameters
+----------
+function (NetworkFunction*)
+: The Network Function object (with annotations and instance data).
+
+payload (uint8_t*)
+: The payload that this function will operate on.
+
+payload_len (size_t)
+: The length of the payload.
+
+Returns
+-------
+0
+: CRC generated, or CRC passed validation.
+
+EBADMSG
+: The CRC failed validation. The message will not be decoded.
+
+EINVAL
+: The CRC does not fit in the payload at the specified position.
+
+ENOMEM
+: Instance data could not be established.
+
+EPROTO
+: A required annotation was not located.
+
+Annotations
+-----------
+position
+: The position (byte offset) of the CRC in the message packet.
+
+data_id
+: (optional) A 16 bit Data ID which is included in the CRC calculation ahead
+  of the message packet (low byte first).
+*/
+
+
+typedef struct CrcInstance {
+    size_t   position;  // Annotation: position
+    uint8_t  data_id[2];
+    uint32_t data_id_len;  // Annotation: data_id (when set)
+} CrcInstance;
+
+
+static int _configure(NetworkFunction* function, CrcInstance** instance)
+{
+    CrcInstance* inst = function->data;
+    if (inst == NULL) {
+        /* First call, create instance data. */
+        const char* value = network_function_annotation(function, "position");
+        if (value == NULL) return EPROTO;
+        inst = calloc(1, sizeof(CrcInstance));
+        if (inst == NULL) return ENOMEM;
+        inst->position = strtoul(value, NULL, 10);
+        value = network_function_annotation(function, "data_id");
+        if (value) {
+            unsigned long data_id = strtoul(value, NULL, 0);
+            inst->data_id[0] = data_id & 0xFF;
+            inst->data_id[1] = (data_id >> 8) & 0xFF;
+            inst->data_id_len = 2;
+        }
+        function->data = inst;
+    }
+    *instance = inst;
+    return 0;
+}
+
+
+static uint32_t _calculate(NetworkCrcType type, CrcInstance* inst,
+    const uint8_t* payload, size_t payload_len)
+{
+    size_t   end = inst->position + network_crc_width(type);
+    uint32_t crc = network_crc_init(type);
+    crc = network_crc_update(type, crc, inst->data_id, inst->data_id_len);
+    crc = network_crc_update(type, crc, payload, inst->position);
+    crc = network_crc_update(type, crc, payload + end, payload_len - end);
+    return network_crc_final(type, crc);
+}
+
+
+static uint32_t _read_crc(const uint8_t* p, size_t width)
+{
+    uint32_t crc = 0;
+    for (size_t i = 0; i < width; i++) {
+        crc = (crc << 8) | p[i];
+    }
+    return crc;
+}
+
+
+static void _write_crc(uint8_t* p, size_t width, uint32_t crc)
+{
+    for (size_t i = width; i > 0; i--) {
+        p[i - 1] = crc & 0xFF;
+        crc >>= 8;
+    }
+}
+
+
+static int _crc_generate(NetworkCrcType type, NetworkFunction* function,
+    uint8_t* payload, size_t payload_len)
+{
+    if (payload == NULL || function == NULL) return EINVAL;
+    CrcInstance* inst;
+    int          rc = _configure(function, &inst);
+    if (rc) return rc;
+    size_t width = network_crc_width(type);
+    if (inst->position + width > payload_len) return EINVAL;
+
+    uint32_t crc = _calculate(type, inst, payload, payload_len);
+    if (_read_crc(payload + inst->position, width) != crc) {
+        _write_crc(payload + inst->position, width, crc);
+        network_function_modified(function);
+    }
+
+    return 0;
+}
+
+
+static int _crc_validate(NetworkCrcType type, NetworkFunction* function,
+    uint8_t* payload, size_t payload_len)
+{
+    if (payload == NULL || function == NULL) return EINVAL;
+    CrcInstance* inst;
+    int          rc = _configure(function, &inst);
+    if (rc) return rc;
+    size_t width = network_crc_width(type);
+    if (inst->position + width > payload_len) return EINVAL;
+
+    uint32_t crc = _calculate(type, inst, payload, payload_len);
+    if (_read_crc(payload + inst->position, width) != crc) return EBADMSG;
+
+    return 0;
+}
+
+
+DLL_PUBLIC int crc8_sae_j1850_generate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_generate(
+        NETWORK_CRC8_SAE_J1850, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc8_sae_j1850_validate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_validate(
+        NETWORK_CRC8_SAE_J1850, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc8h2f_generate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_generate(NETWORK_CRC8H2F, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc8h2f_validate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_validate(NETWORK_CRC8H2F, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc16_ccitt_generate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_generate(NETWORK_CRC16_CCITT, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc16_ccitt_validate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_validate(NETWORK_CRC16_CCITT, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc32_generate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_generate(NETWORK_CRC32, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc32_validate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_validate(NETWORK_CRC32, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc32p4_generate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_generate(NETWORK_CRC32P4, function, payload, payload_len);
+}
+
+
+DLL_PUBLIC int crc32p4_validate(
+    NetworkFunction* function, uint8_t* payload, size_t payload_len)
+{
+    return _crc_validate(NETWORK_CRC32P4, function, payload, payload_len);
+}
@@ -0,0 +1,703 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* dlinfo() */
+#endif
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dse/logger.h>
+#include <dse/network/network.h>
+
+
+#define UNUSED(x) ((void)x)
+
+
+/**
+Network Image
+-------------
+Binary image of a parsed Network (messages, signals and functions) and of the
+message library symbols, which are stored as offsets from the load address of
+the library. The image is keyed by a hash of the Network YAML doc and of the
+message library. When the key of an image (annotation `network_image`) matches
+the image is mapped and the messages are loaded directly, skipping the walk of
+the YAML doc and the dlsym() lookups, otherwise the image is rebuilt.
+
+    ImageHeader
+    ImageMessage[message_count]
+    ImageSignal[signal_count]
+    ImageFunction[function_count]  // Encode then decode, per message.
+    char[string_size]              // NUL terminated strings, 0 is NULL.
+*/
+
+
+#if defined(__linux__)
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <link.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+#define IMAGE_MAGIC   "DSENWIMG"
+#define IMAGE_VERSION 1
+
+
+typedef struct ImageHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t message_count;
+    uint64_t key;
+    uint64_t size;
+    uint32_t signal_count;
+    uint32_t function_count;
+    uint64_t message_offset;
+    uint64_t signal_offset;
+    uint64_t function_offset;
+    uint64_t string_offset;
+    uint64_t string_size;
+} ImageHeader;
+
+
+typedef enum ImageMessageSymbol {
+    IMAGE_SYM_PACK = 0,
+    IMAGE_SYM_UNPACK,
+    IMAGE_SYM_MARSHAL_SIGNALS,
+    IMAGE_SYM_MARSHAL_TX,
+    IMAGE_SYM_MARSHAL_RX,
+    IMAGE_SYM__COUNT,
+} ImageMessageSymbol;
+
+
+typedef struct ImageMessage {
+    /* Strings. */
+    uint32_t name;
+    uint32_t container;
+    uint32_t rx_timeout_signal;
+    /* Properties. */
+    uint32_t frame_id;
+    uint32_t frame_type;
+    uint32_t mux_id;
+    uint32_t buffer_len;
+    uint32_t payload_len;
+    uint32_t cycle_time_ms;
+    uint32_t cycle_time_us;
+    uint32_t cycle_offset_us;
+    uint32_t tx_mode;
+    uint32_t tx_min_delay_us;
+    uint32_t tx_repetitions;
+    uint32_t tx_repetition_us;
+    uint32_t rx_timeout_us;
+    uint32_t rx_timeout_substitute;
+    /* Signals and functions (consecutive records). */
+    uint32_t signal_count;
+    uint32_t encode_count;
+    uint32_t decode_count;
+    /* Symbols (offset from library base, 0 is NULL). */
+    uint64_t symbol[IMAGE_SYM__COUNT];
+} ImageMessage;
+
+
+typedef struct ImageSignal {
+    /* Strings. */
+    uint32_t name;
+    uint32_t signal_name;
+    uint32_t member_type;
+    /* Properties. */
+    uint32_t type;
+    uint32_t buffer_offset;
+    uint8_t  internal;
+    uint8_t  mux_signal;
+    uint8_t  linear;
+    uint8_t  __reserved;
+    double   init_value;
+    double   value;
+    double   factor;
+    double   offset;
+    double   minimum;
+    double   maximum;
+    /* Symbols (encode, decode and is_in_range). */
+    uint64_t symbol[3];
+} ImageSignal;
+
+
+typedef struct ImageFunction {
+    uint32_t name;
+    uint32_t __reserved;
+} ImageFunction;
+
+
+typedef struct ImageStrings {
+    char*  data;
+    size_t size;
+    size_t capacity;
+} ImageStrings;
+
+
+/* Image Key
+   --------- */
+
+static uint64_t _mix(uint64_t h, uint64_t v)
+{
+    uint64_t w[2] = { h, v };
+    return network_hash64((const uint8_t*)w, sizeof(w));
+}
+
+
+static uint64_t _hash_string(uint64_t h, const char* s)
+{
+    if (s == NULL) return _mix(h, 0);
+    return _mix(h, network_hash64((const uint8_t*)s, strlen(s)) + 1);
+}
+
+
+static uint64_t _hash_node(YamlNode* node);
+
+static int _hash_mapping_item(void* map_item, void* additional_data)
+{
+    /* Mapping order is not defined, combine with a commutative sum. */
+    uint64_t* h = additional_data;
+    *h += _hash_node(map_item);
+    return 0;
+}
+
+
+static uint64_t _hash_node(YamlNode* node)
+{
+    uint64_t h = _hash_string(0, node->name);
+    h = _hash_string(h, node->scalar);
+    uint64_t m = 0;
+    hashmap_iterator(&node->mapping, _hash_mapping_item, false, &m);
+    h = _mix(h, m);
+    for (uint32_t i = 0; i < hashlist_length(&node->sequence); i++) {
+        h = _mix(h, _hash_node(hashlist_at(&node->sequence, i)));
+    }
+    return h;
+}
+
+
+static int _hash_file(const char* path, uint64_t* hash)
+{
+    struct stat st;
+    int         fd = open(path, O_RDONLY);
+    if (fd < 0) return 1;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 1;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return 1;
+    *hash = network_hash64(data, st.st_size);
+    munmap(data, st.st_size);
+    return 0;
+}
+
+
+static int _image_key(Network* n, uint64_t* key)
+{
+    uint64_t lib_hash;
+    if (n->doc == NULL || n->message_lib_path == NULL) return 1;
+    if (_hash_file(n->message_lib_path, &lib_hash) != 0) return 1;
+    *key = _mix(_mix(_hash_node(n->doc), lib_hash), IMAGE_VERSION);
+    return 0;
+}
+
+
+/* Library Symbols
+   --------------- */
+
+static int _lib_base(void* handle, uintptr_t* base)
+{
+    struct link_map* lm = NULL;
+    if (handle == NULL) return 1;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &lm) != 0 || lm == NULL) return 1;
+    *base = (uintptr_t)lm->l_addr;
+    return 0;
+}
+
+
+static uint64_t _sym_offset(uintptr_t base, const void* ptr)
+{
+    if (ptr == NULL) return 0;
+    return (uint64_t)((uintptr_t)ptr - base);
+}
+
+
+static void* _sym_ptr(uintptr_t base, uint64_t offset)
+{
+    if (offset == 0) return NULL;
+    return (void*)(base + (uintptr_t)offset);
+}
+
+
+/* Load
+   ---- */
+
+static const char* _image_string(ImageHeader* h, uint32_t offset)
+{
+    if (offset == 0 || offset >= h->string_size) return NULL;
+    return (const char*)h + h->string_offset + offset;
+}
+
+
+/* Size of each signal type (in the message buffer). */
+static const size_t __type_size[NETWORK_SIGNAL_TYPE__COUNT] = {
+    [NETWORK_SIGNAL_TYPE_INT8] = sizeof(int8_t),
+    [NETWORK_SIGNAL_TYPE_UINT8] = sizeof(uint8_t),
+    [NETWORK_SIGNAL_TYPE_INT16] = sizeof(int16_t),
+    [NETWORK_SIGNAL_TYPE_UINT16] = sizeof(uint16_t),
+    [NETWORK_SIGNAL_TYPE_INT32] = sizeof(int32_t),
+    [NETWORK_SIGNAL_TYPE_UINT32] = sizeof(uint32_t),
+    [NETWORK_SIGNAL_TYPE_INT64] = sizeof(int64_t),
+    [NETWORK_SIGNAL_TYPE_UINT64] = sizeof(uint64_t),
+    [NETWORK_SIGNAL_TYPE_FLOAT] = sizeof(float),
+    [NETWORK_SIGNAL_TYPE_DOUBLE] = sizeof(double),
+};
+
+
+static bool _image_valid(ImageHeader* h, size_t size, uint64_t key)
+{
+    if (size < sizeof(ImageHeader)) return false;
+    if (memcmp(h->magic, IMAGE_MAGIC, sizeof(h->magic)) != 0) return false;
+    if (h->version != IMAGE_VERSION || h->key != key) return false;
+    if (h->size != size) return false;
+    if (h->message_offset + h->message_count * sizeof(ImageMessage) > size ||
+        h->signal_offset + h->signal_count * sizeof(ImageSignal) > size ||
+        h->function_offset + h->function_count * sizeof(ImageFunction) >
+            size ||
+        h->string_offset + h->string_size > size) {
+        return false;
+    }
+    /* The string table is NUL terminated (at both ends). */
+    const char* s = (const char*)h + h->string_offset;
+    if (h->string_size == 0 || s[0] || s[h->string_size - 1]) return false;
+    /* The message records reference all signal and function records. */
+    ImageMessage* im = (ImageMessage*)((uint8_t*)h + h->message_offset);
+    uint64_t      signal_count = 0;
+    uint64_t      function_count = 0;
+    for (uint32_t i = 0; i < h->message_count; i++) {
+        signal_count += im[i].signal_count;
+        function_count += im[i].encode_count + im[i].decode_count;
+    }
+    if (signal_count != h->signal_count) return false;
+    if (function_count != h->function_count) return false;
+    /* The signal type indexes the marshal kernels, and each signal is
+    within the buffer of its message. The buffers (struct, shadow and
+    payload) of all messages are allocated from one slab. */
+    ImageSignal* is = (ImageSignal*)((uint8_t*)h + h->signal_offset);
+    uint64_t     slab_size = 0;
+    for (uint32_t i = 0; i < h->message_count; i++) {
+        for (uint32_t j = 0; j < im[i].signal_count; j++, is++) {
+            if (is->type >= NETWORK_SIGNAL_TYPE__COUNT) return false;
+            if ((uint64_t)is->buffer_offset + __type_size[is->type] >
+                im[i].buffer_len) {
+                return false;
+            }
+        }
+        slab_size += (uint64_t)im[i].buffer_len * 2 + im[i].payload_len;
+    }
+    if (slab_size > SIZE_MAX / 2) return false;
+    return true;
+}
+
+
+static YamlNode* _find_in_sequence(
+    YamlNode* node, const char* path, const char* key, const char* value)
+{
+    YamlNode* seq = dse_yaml_find_node(node, path);
+    if (seq == NULL || value == NULL) return NULL;
+    for (uint32_t i = 0; i < hashlist_length(&seq->sequence); i++) {
+        YamlNode*   item = hashlist_at(&seq->sequence, i);
+        const char* scalar = dse_yaml_get_scalar(item, key);
+        if (scalar && strcmp(scalar, value) == 0) return item;
+    }
+    return NULL;
+}
+
+
+static NetworkFunction* _image_functions(Network* n, ImageHeader* h,
+    ImageFunction* f, uint32_t count, YamlNode* msg_node, const char* path)
+{
+    NetworkFunction* nf =
+        network_arena_alloc(&n->arena, (count + 1) * sizeof(NetworkFunction));
+    for (uint32_t i = 0; i < count; i++) {
+        nf[i].name = (char*)_image_string(h, f[i].name);
+        /* Annotations remain in the YAML doc (the image has the same key). */
+        YamlNode* node =
+            _find_in_sequence(msg_node, path, "function", nf[i].name);
+        if (node) nf[i].annotations = dse_yaml_find_node(node, "annotations");
+    }
+    return nf;
+}
+
+
+/* Map message name to message node (of the YAML doc), first match. */
+static void _message_nodes(Network* n, HashMap* map)
+{
+    YamlNode* seq = dse_yaml_find_node(n->doc, "spec/messages");
+    if (seq == NULL) return;
+    for (uint32_t i = 0; i < hashlist_length(&seq->sequence); i++) {
+        YamlNode*   item = hashlist_at(&seq->sequence, i);
+        const char* name = dse_yaml_get_scalar(item, "message");
+        if (name == NULL || hashmap_get(map, name)) continue;
+        hashmap_set(map, name, item);
+    }
+}
+
+
+static NetworkMessage* _image_messages(Network* n, ImageHeader* h)
+{
+    ImageMessage*  im = (ImageMessage*)((uint8_t*)h + h->message_offset);
+    ImageSignal*   is = (ImageSignal*)((uint8_t*)h + h->signal_offset);
+    ImageFunction* ifn = (ImageFunction*)((uint8_t*)h + h->function_offset);
+    uint32_t       signal_idx = 0;
+    uint32_t       function_idx = 0;
+    HashMap        msg_nodes;
+    bool           msg_nodes_loaded = false;
+
+    hashmap_init(&msg_nodes);
+    NetworkMessage* messages = network_arena_alloc(
+        &n->arena, (h->message_count + 1) * sizeof(NetworkMessage));
+    for (uint32_t i = 0; i < h->message_count; i++, im++) {
+        NetworkMessage* nm = &messages[i];
+        nm->name = _image_string(h, im->name);
+        nm->container = _image_string(h, im->container);
+        nm->rx_timeout_signal = _image_string(h, im->rx_timeout_signal);
+        nm->frame_id = im->frame_id;
+        nm->frame_type = im->frame_type;
+        nm->mux_id = im->mux_id;
+        nm->buffer_len = im->buffer_len;
+        nm->payload_len = im->payload_len;
+        nm->cycle_time_ms = im->cycle_time_ms;
+        nm->cycle_time_us = im->cycle_time_us;
+        nm->cycle_offset_us = im->cycle_offset_us;
+        nm->tx_mode = im->tx_mode;
+        nm->tx_min_delay_us = im->tx_min_delay_us;
+        nm->tx_repetitions = im->tx_repetitions;
+        nm->tx_repetition_us = im->tx_repetition_us;
+        nm->rx_timeout_us = im->rx_timeout_us;
+        nm->rx_timeout_substitute = im->rx_timeout_substitute;
+
+        /* Signals. */
+        nm->signals = network_arena_alloc(
+            &n->arena, (im->signal_count + 1) * sizeof(NetworkSignal));
+        nm->signal_info = network_arena_alloc(
+            &n->arena, (im->signal_count + 1) * sizeof(NetworkSignalInfo));
+        for (uint32_t j = 0; j < im->signal_count; j++) {
+            ImageSignal*       s = &is[signal_idx++];
+            NetworkSignal*     ns = &nm->signals[j];
+            NetworkSignalInfo* si = &nm->signal_info[j];
+            si->name = _image_string(h, s->name);
+            si->signal_name = (char*)_image_string(h, s->signal_name);
+            si->member_type = _image_string(h, s->member_type);
+            si->init_value = s->init_value;
+            ns->type = s->type;
+            ns->buffer_offset = s->buffer_offset;
+            ns->internal = s->internal;
+            ns->mux_signal = s->mux_signal;
+            ns->linear = s->linear;
+            ns->value = s->value;
+            ns->factor = s->factor;
+            ns->offset = s->offset;
+            ns->minimum = s->minimum;
+            ns->maximum = s->maximum;
+        }
+
+        /* Functions. */
+        YamlNode* msg_node = NULL;
+        if (im->encode_count || im->decode_count) {
+            if (msg_nodes_loaded == false) {
+                _message_nodes(n, &msg_nodes);
+                msg_nodes_loaded = true;
+            }
+            if (nm->name) msg_node = hashmap_get(&msg_nodes, nm->name);
+        }
+        nm->encode_functions = _image_functions(n, h, &ifn[function_idx],
+            im->encode_count, msg_node, "functions/encode");
+        function_idx += im->encode_count;
+        nm->decode_functions = _image_functions(n, h, &ifn[function_idx],
+            im->decode_count, msg_node, "functions/decode");
+        function_idx += im->decode_count;
+    }
+    hashmap_destroy(&msg_nodes);
+    return messages;
+}
+
+
+int network_image_load(Network* n)
+{
+    struct stat st;
+
+    if (n->image_path == NULL) return 1;
+    if (_image_key(n, &n->image_key) != 0) return 1;
+
+    int fd = open(n->image_path, O_RDONLY);
+    if (fd < 0) return 1;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 1;
+    }
+    void* image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) return 1;
+    if (_image_valid(image, st.st_size, n->image_key) == false) {
+        log_notice("Network image not valid (will rebuild): %s", n->image_path);
+        munmap(image, st.st_size);
+        return 1;
+    }
+
+    n->image = image;
+    n->image_size = st.st_size;
+    n->messages = _image_messages(n, image);
+    log_notice("Network image loaded: %s", n->image_path);
+    return 0;
+}
+
+
+int network_image_resolve(Network* n)
+{
+    uintptr_t base;
+
+    if (n->image == NULL) return 1;
+    if (_lib_base(n->message_lib_handle, &base) != 0) {
+        log_fatal("Network image, message library base not resolved!");
+    }
+
+    ImageHeader*  h = n->image;
+    ImageMessage* im = (ImageMessage*)((uint8_t*)h + h->message_offset);
+    ImageSignal*  is = (ImageSignal*)((uint8_t*)h + h->signal_offset);
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++, im++) {
+        nm->pack_func = _sym_ptr(base, im->symbol[IMAGE_SYM_PACK]);
+        nm->unpack_func = _sym_ptr(base, im->symbol[IMAGE_SYM_UNPACK]);
+        nm->marshal_signals =
+            _sym_ptr(base, im->symbol[IMAGE_SYM_MARSHAL_SIGNALS]);
+        nm->marshal_tx = _sym_ptr(base, im->symbol[IMAGE_SYM_MARSHAL_TX]);
+        nm->marshal_rx = _sym_ptr(base, im->symbol[IMAGE_SYM_MARSHAL_RX]);
+        for (uint32_t j = 0; j < im->signal_count; j++, is++) {
+            network_signal_set_funcs(&nm->signals[j],
+                _sym_ptr(base, is->symbol[0]), _sym_ptr(base, is->symbol[1]),
+                _sym_ptr(base, is->symbol[2]));
+        }
+    }
+
+    return 0;
+}
+
+
+/* Save
+   ---- */
+
+static uint32_t _strings_add(ImageStrings* s, const char* str)
+{
+    if (str == NULL) return 0;
+    size_t len = strlen(str) + 1;
+    if (s->size + len > s->capacity) {
+        while (s->size + len > s->capacity) s->capacity *= 2;
+        s->data = realloc(s->data, s->capacity);
+    }
+    memcpy(s->data + s->size, str, len);
+    s->size += len;
+    return (uint32_t)(s->size - len);
+}
+
+
+static uint32_t _count_functions(NetworkFunction* nf)
+{
+    uint32_t count = 0;
+    for (; nf && nf->name; nf++) count++;
+    return count;
+}
+
+
+static int _image_write(const char* path, ImageHeader* h, ImageMessage* im,
+    ImageSignal* is, ImageFunction* ifn, ImageStrings* strings)
+{
+    /* Write to a temporary file, then rename (concurrent loads). */
+    size_t tmp_len = strlen(path) + 32;
+    char*  tmp = malloc(tmp_len);
+    snprintf(tmp, tmp_len, "%s.%d.tmp", path, (int)getpid());
+
+    FILE* f = fopen(tmp, "wb");
+    if (f == NULL) {
+        log_error("Network image could not be written: %s", tmp);
+        free(tmp);
+        return 1;
+    }
+    bool ok = fwrite(h, sizeof(ImageHeader), 1, f) == 1;
+    ok &= fwrite(im, sizeof(ImageMessage), h->message_count, f) ==
+          h->message_count;
+    ok &= fwrite(is, sizeof(ImageSignal), h->signal_count, f) ==
+          h->signal_count;
+    ok &= fwrite(ifn, sizeof(ImageFunction), h->function_count, f) ==
+          h->function_count;
+    ok &= fwrite(strings->data, 1, strings->size, f) == strings->size;
+    ok &= fclose(f) == 0;
+    if (ok) ok = rename(tmp, path) == 0;
+    if (ok == false) {
+        log_error("Network image could not be written: %s", path);
+        unlink(tmp);
+    }
+    free(tmp);
+    return ok ? 0 : 1;
+}
+
+
+int network_image_save(Network* n)
+{
+    uintptr_t base;
+
+    if (n->image_path == NULL || n->image) return 1;
+    if (n->image_key == 0 && _image_key(n, &n->image_key) != 0) return 1;
+    if (_lib_base(n->message_lib_handle, &base) != 0) return 1;
+
+    /* Count the records. */
+    ImageHeader h = { .version = IMAGE_VERSION, .key = n->image_key };
+    memcpy(h.magic, IMAGE_MAGIC, sizeof(h.magic));
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        h.message_count++;
+        for (NetworkSignalInfo* si = nm->signal_info; si && si->name; si++) {
+            h.signal_count++;
+        }
+        h.function_count += _count_functions(nm->encode_functions);
+        h.function_count += _count_functions(nm->decode_functions);
+    }
+    ImageMessage*  im = calloc(h.message_count + 1, sizeof(ImageMessage));
+    ImageSignal*   is = calloc(h.signal_count + 1, sizeof(ImageSignal));
+    ImageFunction* ifn = calloc(h.function_count + 1, sizeof(ImageFunction));
+    ImageStrings   strings = { .data = calloc(1, 4096), .capacity = 4096 };
+    strings.size = 1; /* Offset 0 is NULL. */
+
+    /* Build the records. */
+    ImageMessage*  m = im;
+    ImageSignal*   s = is;
+    ImageFunction* f = ifn;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++, m++) {
+        m->name = _strings_add(&strings, nm->name);
+        m->container = _strings_add(&strings, nm->container);
+        m->rx_timeout_signal = _strings_add(&strings, nm->rx_timeout_signal);
+        m->frame_id = nm->frame_id;
+        m->frame_type = nm->frame_type;
+        m->mux_id = nm->mux_id;
+        m->buffer_len = nm->buffer_len;
+        m->payload_len = nm->payload_len;
+        m->cycle_time_ms = nm->cycle_time_ms;
+        m->cycle_time_us = nm->cycle_time_us;
+        m->cycle_offset_us = nm->cycle_offset_us;
+        m->tx_mode = nm->tx_mode;
+        m->tx_min_delay_us = nm->tx_min_delay_us;
+        m->tx_repetitions = nm->tx_repetitions;
+        m->tx_repetition_us = nm->tx_repetition_us;
+        m->rx_timeout_us = nm->rx_timeout_us;
+        m->rx_timeout_substitute = nm->rx_timeout_substitute;
+        m->symbol[IMAGE_SYM_PACK] = _sym_offset(base, nm->pack_func);
+        m->symbol[IMAGE_SYM_UNPACK] = _sym_offset(base, nm->unpack_func);
+        m->symbol[IMAGE_SYM_MARSHAL_SIGNALS] =
+            _sym_offset(base, nm->marshal_signals);
+        m->symbol[IMAGE_SYM_MARSHAL_TX] = _sym_offset(base, nm->marshal_tx);
+        m->symbol[IMAGE_SYM_MARSHAL_RX] = _sym_offset(base, nm->marshal_rx);
+        for (NetworkSignalInfo* si = nm->signal_info; si && si->name;
+             si++, s++) {
+            NetworkSignal* ns = &nm->signals[si - nm->signal_info];
+            void *encode, *decode, *range;
+            network_signal_get_funcs(ns, &encode, &decode, &range);
+            s->name = _strings_add(&strings, si->name);
+            s->signal_name = _strings_add(&strings, si->signal_name);
+            s->member_type = _strings_add(&strings, si->member_type);
+            s->type = ns->type;
+            s->buffer_offset = ns->buffer_offset;
+            s->internal = ns->internal;
+            s->mux_signal = ns->mux_signal;
+            s->linear = ns->linear;
+            s->init_value = si->init_value;
+            s->value = ns->value;
+            s->factor = ns->factor;
+            s->offset = ns->offset;
+            s->minimum = ns->minimum;
+            s->maximum = ns->maximum;
+            s->symbol[0] = _sym_offset(base, encode);
+            s->symbol[1] = _sym_offset(base, decode);
+            s->symbol[2] = _sym_offset(base, range);
+            m->signal_count++;
+        }
+        for (NetworkFunction* nf = nm->encode_functions; nf && nf->name;
+             nf++, f++) {
+            f->name = _strings_add(&strings, nf->name);
+            m->encode_count++;
+        }
+        for (NetworkFunction* nf = nm->decode_functions; nf && nf->name;
+             nf++, f++) {
+            f->name = _strings_add(&strings, nf->name);
+            m->decode_count++;
+        }
+    }
+    _strings_add(&strings, ""); /* Terminate the table. */
+
+    /* Layout (records are 8 byte aligned). */
+    h.message_offset = sizeof(ImageHeader);
+    h.signal_offset = h.message_offset + h.message_count * sizeof(ImageMessage);
+    h.function_offset = h.signal_offset + h.signal_count * sizeof(ImageSignal);
+    h.string_offset =
+        h.function_offset + h.function_count * sizeof(ImageFunction);
+    h.string_size = strings.size;
+    h.size = h.string_offset + h.string_size;
+
+    int rc = _image_write(n->image_path, &h, im, is, ifn, &strings);
+    if (rc == 0) log_notice("Network image saved: %s", n->image_path);
+
+    free(im);
+    free(is);
+    free(ifn);
+    free(strings.data);
+    return rc;
+}
+
+
+int network_image_unload(Network* n)
+{
+    if (n == NULL || n->image == NULL) return 0;
+    munmap(n->image, n->image_size);
+    n->image = NULL;
+    n->image_size = 0;
+    return 0;
+}
+
+
+#else /* Network images are not supported on this platform. */
+
+
+int network_image_load(Network* n)
+{
+    UNUSED(n);
+    return 1;
+}
+
+
+int network_image_resolve(Network* n)
+{
+    UNUSED(n);
+    return 1;
+}
+
+
+int network_image_save(Network* n)
+{
+    UNUSED(n);
+    return 1;
+}
+
+
+int network_image_unload(Network* n)
+{
+    UNUSED(n);
+    return 0;
+}
+
+
+#endif
@@ -4,6 +4,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include <setjmp.h>
 #include <dlfcn.h>
 #include <dse/testing.h>
@@ -20,6 +21,7 @@ void* network_load_message_lib(Network* n, const char* dll_path)
     char* dlerror_str;
 
     dlerror();
+    n->descriptor = NULL;
     n->message_lib_handle = dlopen(dll_path, RTLD_NOW | RTLD_LOCAL);
     dlerror_str = dlerror();
     if (dlerror_str) log_fatal(dlerror_str);
@@ -27,13 +29,86 @@ void* network_load_message_lib(Network* n, const char* dll_path)
     return n->message_lib_handle;
 }
 
+/* Network descriptor (optional), older libraries have only the symbols. */
+static const NetworkMessageDescriptor* _load_descriptor(Network* n)
+{
+    char symbol[1024];
+
+    if (n->descriptor || n->message_lib_handle == NULL) return n->descriptor;
+    snprintf(symbol, sizeof(symbol), "%s_network_descriptor", n->name);
+    n->descriptor = dlsym(n->message_lib_handle, symbol);
+    if (n->descriptor) log_debug("Network descriptor loaded (%s)", symbol);
+    return n->descriptor;
+}
+
+
+/* Descriptor tables are searched from a cursor (the tables are typically in
+the same order as the Network messages and signals). */
+static const NetworkMessageDescriptor* _message_descriptor(
+    Network* n, const char* name, size_t* cursor)
+{
+    const NetworkMessageDescriptor* table = n->descriptor;
+    if (table == NULL) return NULL;
+    for (size_t i = *cursor; table[i].name; i++) {
+        if (strcmp(table[i].name, name) == 0) {
+            *cursor = i;
+            return &table[i];
+        }
+    }
+    for (size_t i = 0; i < *cursor; i++) {
+        if (strcmp(table[i].name, name) == 0) {
+            *cursor = i;
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+
+static const NetworkSignalDescriptor* _signal_descriptor(
+    const NetworkMessageDescriptor* md, const char* name, size_t* cursor)
+{
+    if (md == NULL || md->signals == NULL) return NULL;
+    const NetworkSignalDescriptor* table = md->signals;
+    for (size_t i = *cursor; table[i].name; i++) {
+        if (strcmp(table[i].name, name) == 0) {
+            *cursor = i;
+            return &table[i];
+        }
+    }
+    for (size_t i = 0; i < *cursor; i++) {
+        if (strcmp(table[i].name, name) == 0) {
+            *cursor = i;
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+
 int network_load_message_funcs(Network* n)
 {
-    void* handle = n->message_lib_handle;
-    char  func_name[1024];
+    void*  handle = n->message_lib_handle;
+    char   func_name[1024];
+    size_t cursor = 0;
+
+    _load_descriptor(n);
 
     /* Loop over messages. */
     for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        const NetworkMessageDescriptor* md = _message_descriptor(
+            n, nm->container ? nm->container : nm->name, &cursor);
+        if (md) {
+            nm->pack_func = (PackFunc)md->pack;
+            nm->unpack_func = (UnpackFunc)md->unpack;
+            if (nm->pack_func == NULL || nm->unpack_func == NULL)
+                log_error("Network function not loaded (%s)", md->name);
+            nm->marshal_signals = nm->container ? NULL : md->marshal_signals;
+            nm->marshal_tx = nm->container ? NULL : md->marshal_tx;
+            nm->marshal_rx = nm->container ? NULL : md->marshal_rx;
+            continue;
+        }
+
         // If container is specified, then load functions from the
         // container message (they are common with this message).
 
@@ -49,18 +124,63 @@ int network_load_message_funcs(Network* n)
         nm->unpack_func = (UnpackFunc)dlsym(handle, func_name);
         if (nm->unpack_func == NULL)
             log_error("Network function not loaded (%s)", func_name);
+        // Fused marshal functions (optional, not for container messages).
+        nm->marshal_signals = NULL;
+        nm->marshal_tx = NULL;
+        nm->marshal_rx = NULL;
+        if (nm->container) continue;
+        snprintf(func_name, sizeof(func_name), "%s_%s_marshal_signals",
+            n->name, nm->name);
+        nm->marshal_signals = (const char**)dlsym(handle, func_name);
+        snprintf(func_name, sizeof(func_name), "%s_%s_marshal_tx", n->name,
+            nm->name);
+        nm->marshal_tx = (MarshalTxFunc)dlsym(handle, func_name);
+        snprintf(func_name, sizeof(func_name), "%s_%s_marshal_rx", n->name,
+            nm->name);
+        nm->marshal_rx = (MarshalRxFunc)dlsym(handle, func_name);
     }
 
     return 0;
 }
 
+/* Set the function pointers of a signal (typed according to its type). */
+int network_signal_set_funcs(
+    NetworkSignal* ns, void* encode, void* decode, void* range)
+{
+    if (ns->type == NETWORK_SIGNAL_TYPE_UNKNOWN ||
+        ns->type >= NETWORK_SIGNAL_TYPE__COUNT) {
+        return 1;
+    }
+    ns->encode_func = encode;
+    ns->decode_func = decode;
+    ns->range_func = range;
+    return 0;
+}
+
+
+/* Get the function pointers of a signal (NULL for an unknown type). */
+void network_signal_get_funcs(
+    NetworkSignal* ns, void** encode, void** decode, void** range)
+{
+    *encode = *decode = *range = NULL;
+    if (ns->type == NETWORK_SIGNAL_TYPE_UNKNOWN ||
+        ns->type >= NETWORK_SIGNAL_TYPE__COUNT) {
+        return;
+    }
+    *encode = ns->encode_func;
+    *decode = ns->decode_func;
+    *range = ns->range_func;
+}
+
+
 typedef struct {
     const char* name;
     void*       func;
 } NetFunc_t;
 
-static void __load_network_funcs(
-    Network* n, NetworkMessage* nm, NetworkSignal* ns)
+static void __load_network_funcs(Network* n, NetworkMessage* nm,
+    NetworkSignal* ns, NetworkSignalInfo* si,
+    const NetworkMessageDescriptor* md, size_t* cursor)
 {
     NetFunc_t net_func[] = {
         { .name = "encode" },
@@ -69,12 +189,19 @@ static void __load_network_funcs(
     };
     void* handle = n->message_lib_handle;
 
-    for (uint32_t i = 0; i < ARRAY_SIZE(net_func); i++) {
+    const NetworkSignalDescriptor* sd =
+        _signal_descriptor(md, si->name, cursor);
+    if (sd) {
+        net_func[0].func = sd->encode;
+        net_func[1].func = sd->decode;
+        net_func[2].func = sd->range;
+    }
+    for (uint32_t i = 0; sd == NULL && i < ARRAY_SIZE(net_func); i++) {
         char func_name[1024];
         // If container is specified, then load functions from the
         // container message (they are common with this message).
         snprintf(func_name, sizeof(func_name), "%s_%s_%s_%s", n->name,
-            nm->container ? nm->container : nm->name, ns->name,
+            nm->container ? nm->container : nm->name, si->name,
             net_func[i].name);
         net_func[i].func = dlsym(handle, func_name);
         if (net_func[i].func == NULL)
@@ -86,46 +213,74 @@ static void __load_network_funcs(
             "Missing network functions or bad network signal configuration!");
     }
 
-    if ((strcmp(ns->member_type, "int8_t") == 0) ||
-        (strcmp(ns->member_type, "uint8_t") == 0)) {
-        ns->encode_func_int8 = net_func[0].func;
-        ns->decode_func_int8 = net_func[1].func;
-        ns->range_func_int8 = net_func[2].func;
-    }
-    if ((strcmp(ns->member_type, "int16_t") == 0) ||
-        (strcmp(ns->member_type, "uint16_t") == 0)) {
-        ns->encode_func_int16 = net_func[0].func;
-        ns->decode_func_int16 = net_func[1].func;
-        ns->range_func_int16 = net_func[2].func;
-    } else if ((strcmp(ns->member_type, "int32_t") == 0) ||
-               (strcmp(ns->member_type, "uint32_t") == 0)) {
-        ns->encode_func_int32 = net_func[0].func;
-        ns->decode_func_int32 = net_func[1].func;
-        ns->range_func_int32 = net_func[2].func;
-    } else if ((strcmp(ns->member_type, "int64_t") == 0) ||
-               (strcmp(ns->member_type, "uint64_t") == 0)) {
-        ns->encode_func_int64 = net_func[0].func;
-        ns->decode_func_int64 = net_func[1].func;
-        ns->range_func_int64 = net_func[2].func;
-    } else if (strcmp(ns->member_type, "float") == 0) {
-        ns->encode_func_float = net_func[0].func;
-        ns->decode_func_float = net_func[1].func;
-        ns->range_func_float = net_func[2].func;
-    } else if (strcmp(ns->member_type, "double") == 0) {
-        ns->encode_func_double = net_func[0].func;
-        ns->decode_func_double = net_func[1].func;
-        ns->range_func_double = net_func[2].func;
+    /* Signals constructed without the parser need their type resolved. */
+    if (ns->type == NETWORK_SIGNAL_TYPE_UNKNOWN) {
+        ns->type = network_signal_type(si->member_type);
+    }
+    if (network_signal_set_funcs(
+            ns, net_func[0].func, net_func[1].func, net_func[2].func)) {
+        log_error("Unknown type: %s (message=%s, signal=%s)", si->member_type,
+            nm->name, si->name);
     }
 }
 
 
 int network_load_signal_funcs(Network* n)
 {
+    size_t cursor = 0;
+
+    _load_descriptor(n);
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        const NetworkMessageDescriptor* md = _message_descriptor(
+            n, nm->container ? nm->container : nm->name, &cursor);
+        size_t signal_cursor = 0;
+        for (NetworkSignalInfo* si = nm->signal_info; si && si->name; si++) {
+            NetworkSignal* ns = &nm->signals[si - nm->signal_info];
+            if (ns->inactive) {
+                /* Inactive signals with linear scaling are encoded
+                (init_value) by the native codec, otherwise the functions
+                are needed. */
+                if (ns->type == NETWORK_SIGNAL_TYPE_UNKNOWN) {
+                    ns->type = network_signal_type(si->member_type);
+                }
+                if (network_signal_linear(ns)) continue;
+            }
+            __load_network_funcs(n, nm, ns, si, md, &signal_cursor);
+        }
+    }
+    return 0;
+}
+
+
+/* Lazy loading, signals not in the signal filter are marked inactive (they
+are not marshalled, their init_value is encoded once at load). Internal and
+mux signals are always loaded. */
+int network_filter_signals(Network* n)
+{
+    if (n->signal_filter == NULL) return 1;
+
+    HashMap filter;
+    hashmap_init(&filter);
+    for (size_t i = 0; i < n->signal_filter_count; i++) {
+        const char* name = n->signal_filter[i];
+        if (name) hashmap_set(&filter, name, (void*)name);
+    }
+    size_t count = 0;
     for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
-        for (NetworkSignal* ns = nm->signals; ns && ns->name; ns++) {
-            __load_network_funcs(n, nm, ns);
+        for (NetworkSignalInfo* si = nm->signal_info; si && si->name; si++) {
+            NetworkSignal* ns = &nm->signals[si - nm->signal_info];
+            ns->inactive = false;
+            if (ns->internal || ns->mux_signal) continue;
+            if (si->signal_name && hashmap_get(&filter, si->signal_name)) {
+                continue;
+            }
+            ns->inactive = true;
+            count++;
         }
     }
+    hashmap_destroy(&filter);
+    log_notice("Lazy loading, inactive signals: %zu", count);
+
     return 0;
 }
 
@@ -17,10 +17,12 @@
 #define UNUSED(x)     ((void)x)
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
+/* Mapping of SignalVector signals to the Network signal_vector, as runs of
+signals which are contiguous in both vectors (ordered by vector_index). */
 typedef struct SRMap {
-    bool     active;
     uint32_t vector_index;
-    size_t   signal_index;
+    uint32_t signal_index;
+    uint32_t count;
 } SRMap;
 
 
@@ -28,17 +30,43 @@ typedef struct {
     ModelDesc     model;
     /* Runnable model object. */
     Network       network;
-    /* Ticks. */
-    bool          init_tick_done;
-    double        last_tick;
     /* Signal vectors. */
     SignalVector* sv_signal;
     SignalVector* sv_network;
     uint32_t      sv_network_index;
     NCODEC*       network_codec;
     SRMap*        __sr_map;
+    size_t        __sr_map_count;
 } NetworkModelDesc;
 
+static void _sr_map_rx(NetworkModelDesc* m)
+{
+    for (size_t r = 0; r < m->__sr_map_count; r++) {
+        const SRMap*  map = &m->__sr_map[r];
+        const double* src = m->sv_signal->scalar + map->vector_index;
+        double*       dst = m->network.signal_vector + map->signal_index;
+        for (uint32_t i = 0; i < map->count; i++) {
+            if (dst[i] == src[i]) continue;
+            dst[i] = src[i];
+            network_signal_changed(&m->network, map->signal_index + i);
+            log_trace("RX signals.signal_vector[%d] = %f",
+                map->signal_index + i, src[i]);
+        }
+    }
+}
+
+
+static void _sr_map_tx(NetworkModelDesc* m)
+{
+    for (size_t r = 0; r < m->__sr_map_count; r++) {
+        const SRMap* map = &m->__sr_map[r];
+        memcpy(m->sv_signal->scalar + map->vector_index,
+            m->network.signal_vector + map->signal_index,
+            map->count * sizeof(double));
+    }
+}
+
+
 static inline double* _index(NetworkModelDesc* m, const char* v, const char* s)
 {
     ModelSignalIndex idx = signal_index((ModelDesc*)m, v, s);
@@ -66,9 +94,12 @@ ModelDesc* model_create(ModelDesc* model)
         m->model.mi->spec, "annotations/network", &m->network.name);
     log_notice("Network: %s", m->network.name);
 
+    /* Signals of the SignalVector (filter for lazy loading). */
+    m->network.signal_filter = m->sv_signal->signal;
+    m->network.signal_filter_count = m->sv_signal->count;
     int rc = network_load(&m->network, m->model.mi);
     if (rc) log_fatal("Network load failed!");
-    network_schedule_reset(&m->network);
+    m->network.signal_filter = NULL;
 
     /* Locate the Network signal. */
     const char* network_signal = NULL;
@@ -102,37 +133,73 @@ ModelDesc* model_create(ModelDesc* model)
 
     /* Print the parsed network. */
     log_notice("  Network Configuration:");
-    uint32_t sig_idx = 0;
+    uint32_t name_idx = 0;
     for (NetworkMessage* nm = m->network.messages; nm && nm->name; nm++) {
         log_notice("    %s [frame_id 0x%x, len %d]", nm->name, nm->frame_id,
             nm->buffer_len);
-        for (NetworkSignal* sig = nm->signals;
-            sig->name && sig_idx < m->network.signal_count; sig++) {
-            const char* signal_name = m->network.signal_name[sig_idx++];
-            log_notice("        %s [%s]", signal_name, sig->name);
+        for (NetworkSignalInfo* si = nm->signal_info;
+            si->name && name_idx < m->network.signal_count; si++) {
+            if (nm->signals[si - nm->signal_info].inactive) continue;
+            const char* signal_name = m->network.signal_name[name_idx++];
+            log_notice("        %s [%s]", signal_name, si->name);
         }
     }
 
-    /* Create the SignalVector mapping. */
+    /* Create the SignalVector mapping (hash join on the signal name). */
     log_notice("  SignalVector<->Network Mapping:");
+    HashMap signal_map;
+    hashmap_init(&signal_map);
+    bool* mapped = calloc(m->network.signal_count, sizeof(bool));
+    for (size_t sig_idx = 0; sig_idx < m->network.signal_count; sig_idx++) {
+        const char** nt_sig_name = &m->network.signal_name[sig_idx];
+        if (strlen(*nt_sig_name) == 0) continue;  // Skip internal signals.
+        if (hashmap_get(&signal_map, *nt_sig_name)) {
+            log_error("    Duplicate network signal: %s (index=%zu)",
+                *nt_sig_name, sig_idx);
+            continue;
+        }
+        hashmap_set(&signal_map, *nt_sig_name, (void*)nt_sig_name);
+    }
     m->__sr_map = calloc(m->sv_signal->count, sizeof(SRMap));
     for (uint32_t sv_idx = 0; sv_idx < m->sv_signal->count; sv_idx++) {
-        for (size_t sig_idx = 0; sig_idx < m->network.signal_count; sig_idx++) {
-            const char* sv_sig_name = m->sv_signal->signal[sv_idx];
-            const char* nt_sig_name = m->network.signal_name[sig_idx];
-            log_debug("mapping attempt (signal/network): %s and %s",
-                sv_sig_name, nt_sig_name);
-            if (strcmp(sv_sig_name, nt_sig_name) != 0) continue;
-            if (strlen(nt_sig_name) == 0) continue;  // Skip internal signals.
-            /* Mapping found. */
-            m->__sr_map[sv_idx].active = true;
-            m->__sr_map[sv_idx].vector_index = sv_idx;
-            m->__sr_map[sv_idx].signal_index = sig_idx;
-            log_notice("    [%d]:[%d] %s->%s", sv_idx, sig_idx, sv_sig_name,
-                nt_sig_name);
-            break;
+        const char*  sv_sig_name = m->sv_signal->signal[sv_idx];
+        const char** nt_sig_name = hashmap_get(&signal_map, sv_sig_name);
+        if (nt_sig_name == NULL) {
+            log_notice("    [%d]:[-] %s (not mapped)", sv_idx, sv_sig_name);
+            continue;
+        }
+        size_t sig_idx = nt_sig_name - m->network.signal_name;
+        if (mapped[sig_idx]) {
+            log_error("    [%d]:[%zu] %s (duplicate SignalVector signal)",
+                sv_idx, sig_idx, sv_sig_name);
+            continue;
+        }
+        /* Mapping found, extend the current run or start a new run. */
+        SRMap* map = m->__sr_map_count
+                         ? &m->__sr_map[m->__sr_map_count - 1]
+                         : NULL;
+        if (map && map->vector_index + map->count == sv_idx &&
+            map->signal_index + map->count == sig_idx) {
+            map->count++;
+        } else {
+            m->__sr_map[m->__sr_map_count++] = (SRMap){
+                .vector_index = sv_idx,
+                .signal_index = sig_idx,
+                .count = 1,
+            };
         }
+        mapped[sig_idx] = true;
+        log_notice("    [%d]:[%zu] %s->%s", sv_idx, sig_idx, sv_sig_name,
+            *nt_sig_name);
     }
+    for (size_t sig_idx = 0; sig_idx < m->network.signal_count; sig_idx++) {
+        const char* nt_sig_name = m->network.signal_name[sig_idx];
+        if (mapped[sig_idx] || strlen(nt_sig_name) == 0) continue;
+        log_notice("    [-]:[%zu] %s (not mapped)", sig_idx, nt_sig_name);
+    }
+    log_debug("  SignalVector<->Network copy runs: %zu", m->__sr_map_count);
+    free(mapped);
+    hashmap_destroy(&signal_map);
     if (m->network.netoff_signal) {
         m->network.netoff_value =
             _index(m, "signal_channel", m->network.netoff_signal);
@@ -144,29 +211,37 @@ ModelDesc* model_create(ModelDesc* model)
             log_notice(
                 "Network-Off signal found: %s ", m->network.netoff_signal);
     }
+    for (NetworkMessage* nm = m->network.messages; nm && nm->name; nm++) {
+        if (nm->rx_timeout_signal == NULL) continue;
+        nm->rx_timeout_value =
+            _index(m, "signal_channel", nm->rx_timeout_signal);
+        if (nm->rx_timeout_value == NULL)
+            log_error("RX timeout signal : %s found in annotations but not in "
+                      "signalgroup",
+                nm->rx_timeout_signal);
+    }
 
     /* Set the SignalVector initial value. */
     for (MarshalItem* mi = m->network.marshal_list; mi && mi->signal; mi++) {
         size_t sig_idx = mi->signal_vector_index;
-        m->network.signal_vector[sig_idx] = mi->signal->init_value;
-        log_debug("signal: %s init_value %f", mi->signal->name,
-            mi->signal->init_value);
-    }
-    for (uint32_t i = 0; i < m->sv_signal->count; i++) {
-        if (m->__sr_map[i].active == false) continue;
-        uint32_t sv_idx = m->__sr_map[i].vector_index;
-        size_t   sig_idx = m->__sr_map[i].signal_index;
-        m->sv_signal->scalar[sv_idx] = m->network.signal_vector[sig_idx];
+        m->network.signal_vector[sig_idx] = mi->info->init_value;
+        log_debug("signal: %s init_value %f", mi->info->name,
+            mi->info->init_value);
     }
+    _sr_map_tx(m);
 
     /* Trigger checksum calculation. */
     network_marshal_signals_to_messages(&m->network, m->network.marshal_list);
     network_pack_messages(&m->network);
     for (NetworkMessage* nm = m->network.messages; nm && nm->name; nm++) {
         nm->needs_tx = false;
-        log_debug("message: %s checksum %d", nm->name, nm->buffer_checksum);
+        log_debug("message: %s checksum %016llx", nm->name,
+            (unsigned long long)network_hash64(nm->buffer, nm->buffer_len));
     }
 
+    /* Reset the schedule, after the initial pack (which does not TX). */
+    network_schedule_reset(&m->network);
+
     /* Return the extended object. */
     return (ModelDesc*)m;
 }
@@ -176,66 +251,36 @@ int model_step(ModelDesc* model, double* model_time, double stop_time)
 {
     NetworkModelDesc* m = (NetworkModelDesc*)model;
 
-    /* RX: SignalVector -> Network. */
-    for (uint32_t i = 0; i < m->sv_signal->count; i++) {
-        if (m->__sr_map[i].active == false) continue;
-        uint32_t sv_idx = m->__sr_map[i].vector_index;
-        size_t   sig_idx = m->__sr_map[i].signal_index;
-        m->network.signal_vector[sig_idx] = m->sv_signal->scalar[sv_idx];
-        log_trace("RX signals.signal_vector[%d] = %f", sig_idx,
-            m->sv_signal->scalar[sv_idx]);
-    }
+    /* RX: SignalVector -> Network (changed signals are marked for TX). */
+    _sr_map_rx(m);
     network_decode_from_bus(&m->network, m->network_codec);
     network_function_apply_decode(&m->network);
-    network_marshal_messages_to_signals(
-        &m->network, m->network.marshal_list, false);
+    network_marshal_updated_messages(&m->network);
     signal_release(m->sv_network, m->sv_network_index);
 
 
-    /* The network tasks are organised on a 1 ms schedule and need to be
-    ticked at that cadence, even if the task themselves are on a slacker
-    schedule (e.g. 5 ms). */
-
-
-    /* The initial tick should occur only once. */
-    if (*model_time == 0.0) {
-        if (m->init_tick_done == false) {
-            log_trace("Tick at model_time %f", *model_time);
-            network_schedule_tick(&m->network);
-            m->init_tick_done = true;
-        }
-    }
-
-    /* How many ticks should occur in this step? Due to floating point
-    accuracy, push the ticks a little (1.01) to be sure that the int
-    conversion rounds down to 1 (and not
-     from 0.999999 to 0). */
-
-    int ticks = (((*model_time - m->last_tick) / 0.001) * 1.01);
-    if (ticks) {
-        for (int t = 0; t < ticks; t++) {
-            log_trace("Tick at model_time %f", *model_time);
-            network_schedule_tick(&m->network);
-            m->last_tick = *model_time;
-        }
+    /* The network tasks are organised on a schedule with a fixed tick
+    (schedule_resolution_us). Advance the schedule, in one call, to include
+    the tick at (or before) the current model time (tick 0 is at model_time
+    0). Time is rounded to integer nanoseconds so that the tick count does
+    not drift. */
+    uint64_t tick_ns = m->network.schedule_resolution_us * 1000ULL;
+    uint64_t time_ns = (uint64_t)(*model_time * 1e9 + 0.5);
+    uint64_t ticks = time_ns / tick_ns + 1;
+    if (ticks > m->network.tick) {
+        log_trace("Tick at model_time %f (ticks=%llu)", *model_time,
+            (unsigned long long)(ticks - m->network.tick));
+        network_schedule_advance(&m->network, ticks - m->network.tick);
     }
 
-    network_marshal_signals_to_messages(&m->network, m->network.marshal_list);
-    network_pack_messages(&m->network);
+    network_marshal_changed_signals(&m->network);
+    network_pack_changed_messages(&m->network);
     network_function_apply_encode(&m->network);
     network_encode_to_bus(&m->network, m->network_codec);
-    network_marshal_messages_to_signals(
-        &m->network, m->network.marshal_list, false);
+    network_marshal_updated_messages(&m->network);
 
     /* TX: Network->SignalVector. */
-    for (uint32_t i = 0; i < m->sv_signal->count; i++) {
-        if (m->__sr_map[i].active == false) continue;
-        uint32_t sv_idx = m->__sr_map[i].vector_index;
-        size_t   sig_idx = m->__sr_map[i].signal_index;
-        m->sv_signal->scalar[sv_idx] = m->network.signal_vector[sig_idx];
-        log_trace(
-            "TX sv.scalar[%d] = %f", sv_idx, m->network.signal_vector[sig_idx]);
-    }
+    _sr_map_tx(m);
 
     /* Advance the model time. */
     *model_time = stop_time;
@@ -21,15 +21,21 @@ int network_load(Network* n, ModelInstanceSpec* mi)
     assert(n);
 
     network_parse(n, mi);
+    if (n->lazy_signals) network_filter_signals(n);
     network_load_message_lib(n, n->message_lib_path);
     network_load_function_lib(n, n->function_lib_path);
     network_load_function_funcs(n);
-    network_load_signal_funcs(n);
-    network_load_message_funcs(n);
+    if (network_image_resolve(n) != 0) {
+        network_load_signal_funcs(n);
+        network_load_message_funcs(n);
+        /* The image must hold the functions of all signals. */
+        if (n->lazy_signals == false) network_image_save(n);
+    }
     network_load_marshal_lists(n);
     network_get_signal_names(
         n->marshal_list, &n->signal_name, &n->signal_count);
     n->signal_vector = calloc(n->signal_count, sizeof(double));
+    network_load_marshal_plan(n);
     for (size_t i = 0; i < n->signal_count; i++) {
         log_info("Network Signal [%d] : %s", i, n->signal_name[i]);
     }
@@ -44,10 +50,17 @@ int network_unload(Network* n)
 
     network_unload_parser(n);
     network_unload_marshal_lists(n);
+    network_image_unload(n);
     if (n) {
         if (n->signal_name) free(n->signal_name);
         if (n->signal_vector) free(n->signal_vector);
         if (n->schedule_list) free(n->schedule_list);
+        if (n->schedule_heap) free(n->schedule_heap);
+        n->signal_name = NULL;
+        n->signal_vector = NULL;
+        n->schedule_list = NULL;
+        n->schedule_heap = NULL;
+        network_arena_release(&n->arena);
     }
 
     return 0;
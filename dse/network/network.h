@@ -27,9 +27,13 @@ between Physical Signals and Network Messages.
 
 
 /* Forward declarations. */
-typedef struct NetworkMessage  NetworkMessage;
-typedef struct NetworkFunction NetworkFunction;
-typedef struct MarshalItem     MarshalItem;
+typedef struct NetworkMessage      NetworkMessage;
+typedef struct NetworkFunction     NetworkFunction;
+typedef struct MarshalItem         MarshalItem;
+typedef struct MarshalSlice        MarshalSlice;
+typedef struct NetworkFrameIndex   NetworkFrameIndex;
+typedef struct NetworkScheduleItem NetworkScheduleItem;
+typedef struct NetworkArenaBlock   NetworkArenaBlock;
 
 /*
 Message Library
@@ -63,6 +67,33 @@ typedef bool (*RangeFuncDouble)(double value);
 typedef int (*PackFunc)(uint8_t*, const void*, size_t);
 typedef int (*UnpackFunc)(void*, const uint8_t*, size_t);
 
+/* Fused marshal functions (optional), encode/decode all signals of a message
+between the signal vector (sv[idx[i]]) and the message struct (buffer). */
+typedef void (*MarshalTxFunc)(
+    const double* sv, const uint32_t* idx, void* buffer);
+typedef void (*MarshalRxFunc)(
+    double* sv, const uint32_t* idx, const void* buffer);
+
+/* Network descriptor (optional), a NULL terminated table of the messages and
+signals of the library, exported as `<network>_network_descriptor`. When
+present the functions are loaded from the table (single symbol lookup). */
+typedef struct NetworkSignalDescriptor {
+    const char* name;
+    void*       encode;
+    void*       decode;
+    void*       range;
+} NetworkSignalDescriptor;
+
+typedef struct NetworkMessageDescriptor {
+    const char*                    name;
+    void*                          pack;
+    void*                          unpack;
+    const NetworkSignalDescriptor* signals;  // NULL terminated list.
+    const char**                   marshal_signals;
+    void*                          marshal_tx;
+    void*                          marshal_rx;
+} NetworkMessageDescriptor;
+
 
 /*
 Function Library
@@ -73,6 +104,7 @@ flow) which are loaded from the Function Library (annotation `function_lib`).
 void        network_message_recalculate(NetworkMessage* message);
 const char* network_function_annotation(
     NetworkFunction* function, const char* name);
+void        network_function_modified(NetworkFunction* function);
 
 typedef int (*NetworkFunctionFunc)(
     NetworkFunction* function, uint8_t* payload, size_t payload_len);
@@ -82,50 +114,83 @@ typedef struct NetworkFunction {
     YamlNode* annotations;
     void*     data;
 
+    /* Modification reporting (optional). Functions which report (i.e. call
+    network_function_modified() when the payload is changed) set
+    reports_modified, otherwise the engine compares the payload. */
+    bool reports_modified;
+    bool modified;  // Reset by the engine before each call.
+
     /* Function pointers (loaded from library). */
     NetworkFunctionFunc function;
 } NetworkFunction;
 
 
+typedef enum NetworkSignalType {
+    NETWORK_SIGNAL_TYPE_UNKNOWN = 0,
+    NETWORK_SIGNAL_TYPE_INT8,
+    NETWORK_SIGNAL_TYPE_UINT8,
+    NETWORK_SIGNAL_TYPE_INT16,
+    NETWORK_SIGNAL_TYPE_UINT16,
+    NETWORK_SIGNAL_TYPE_INT32,
+    NETWORK_SIGNAL_TYPE_UINT32,
+    NETWORK_SIGNAL_TYPE_INT64,
+    NETWORK_SIGNAL_TYPE_UINT64,
+    NETWORK_SIGNAL_TYPE_FLOAT,
+    NETWORK_SIGNAL_TYPE_DOUBLE,
+    /* Count of types (not a type). */
+    NETWORK_SIGNAL_TYPE__COUNT,
+} NetworkSignalType;
+
+
 typedef struct NetworkSignal {
-    const char*      name;
-    char*            signal_name;
-    /* Annotations. */
-    const char*      member_type;
-    unsigned int     buffer_offset;
-    double           init_value;  // Initial value (at T=0).
-    bool             internal;
-    double           value;  // Constant value (at T=[0..t])
-    /* Container message: Mux signal. */
-    bool             mux_signal;
-    MarshalItem*     mux_mi;  // Only set if _this_ is the mux signal.
-    /* Function pointers (loaded from library). */
-    EncodeFuncInt8   encode_func_int8;
-    EncodeFuncInt16  encode_func_int16;
-    EncodeFuncInt32  encode_func_int32;
-    EncodeFuncInt64  encode_func_int64;
-    EncodeFuncFloat  encode_func_float;
-    EncodeFuncDouble encode_func_double;
-    DecodeFuncInt8   decode_func_int8;
-    DecodeFuncInt16  decode_func_int16;
-    DecodeFuncInt32  decode_func_int32;
-    DecodeFuncInt64  decode_func_int64;
-    DecodeFuncFloat  decode_func_float;
-    DecodeFuncDouble decode_func_double;
-    RangeFuncInt8    range_func_int8;
-    RangeFuncInt16   range_func_int16;
-    RangeFuncInt32   range_func_int32;
-    RangeFuncInt64   range_func_int64;
-    RangeFuncFloat   range_func_float;
-    RangeFuncDouble  range_func_double;
+    /* Marshal properties. */
+    NetworkSignalType type;  // Resolved from member_type (at load).
+    unsigned int      buffer_offset;
+    bool              internal;    // Marshal the constant value.
+    bool              mux_signal;  // Container message: Mux signal.
+    bool              linear;      // Native linear codec (see factor/offset).
+    bool              inactive;    // Not loaded or marshalled (lazy loading).
+    double            value;       // Constant value (at T=[0..t])
+    /* Function slots (loaded from library), typed according to type. */
+    void*             encode_func;
+    void*             decode_func;
+    void*             range_func;
+    /* Container message: only set if _this_ is the mux signal. */
+    MarshalItem*      mux_mi;
+    /* Linear scaling (native codec, library functions are not called). */
+    double            factor;
+    double            offset;
+    double            minimum;
+    double            maximum;
 } NetworkSignal;
 
 
+/* Names and annotations of a signal (not used by marshal operations), kept
+out of line in an array indexed in parallel with NetworkMessage.signals. */
+typedef struct NetworkSignalInfo {
+    const char* name;
+    char*       signal_name;
+    const char* member_type;
+    double      init_value;  // Initial value (at T=0).
+} NetworkSignalInfo;
+
+
+/* Transmission modes (AUTOSAR COM), annotation tx_mode. The default mode is
+periodic for messages with a cycle time, otherwise direct. */
+typedef enum NetworkTxMode {
+    NETWORK_TX_MODE_DEFAULT = 0,
+    NETWORK_TX_MODE_PERIODIC,  // TX on the cycle.
+    NETWORK_TX_MODE_DIRECT,    // TX on change (with repetitions).
+    NETWORK_TX_MODE_MIXED,     // Periodic and direct.
+} NetworkTxMode;
+
+
 typedef struct NetworkMessage {
     const char*    name;
     uint32_t       frame_id;
     uint8_t        frame_type;
-    NetworkSignal* signals;  // NULL terminated list.
+    NetworkSignal* signals;  // Indexed in parallel with signal_info.
+    NetworkSignalInfo* signal_info;  // NULL terminated list (name).
     /* Container Messages (typically name is <container>_<mux_id>). */
     const char*    container;  // Name of container message.
     uint32_t       mux_id;
@@ -134,15 +199,48 @@ typedef struct NetworkMessage {
     void*          buffer;
     size_t         buffer_len;
     uint16_t        cycle_time_ms;
+    uint32_t       cycle_time_us;    // Scheduled cycle time, microseconds.
+    uint32_t       cycle_offset_us;  // Phase of the cycle, microseconds.
     /* Payload (object of pack/unpack operations). */
     void*          payload;
     uint8_t        payload_len;
     /* Operational properties. */
-    uint32_t       buffer_checksum;
+    void*          buffer_shadow;  // Buffer at last RX/TX (change detection).
+    bool           buffer_shadow_valid;
     bool           needs_tx;
+    bool           needs_pack;  // Set when a signal of the message changed.
     PackFunc       pack_func;
     UnpackFunc     unpack_func;
     bool           update_signals;
+    bool           update_queued;  // Message is on the Network update_list.
+    /* Marshal items of this message (slice of the Network marshal_list). */
+    MarshalItem*   marshal_items;
+    size_t         marshal_count;
+    MarshalSlice*  marshal_slices;  // Of the MarshalPlan groups (when loaded).
+    size_t         marshal_slice_count;
+    /* Fused marshal functions (loaded from library, if present). */
+    const char**   marshal_signals;  // Struct members, in function order.
+    MarshalTxFunc  marshal_tx;
+    MarshalRxFunc  marshal_rx;
+    uint32_t*      marshal_index;  // Set when the functions are usable.
+
+    /* Transmission mode and timing (MDT applies to all TX). */
+    NetworkTxMode        tx_mode;
+    uint32_t             tx_min_delay_us;   // Minimum delay time (MDT).
+    uint32_t             tx_repetitions;    // Repetitions of a direct TX.
+    uint32_t             tx_repetition_us;  // Repetition period.
+    NetworkScheduleItem* schedule_item;     // Set by network_schedule_reset.
+
+    /* RX deadline monitoring. */
+    uint32_t    rx_timeout_us;          // Deadline, 0 to disable.
+    bool        rx_timeout_substitute;  // Substitute init values on timeout.
+    const char* rx_timeout_signal;      // Status signal, 1 when timed out.
+    double*     rx_timeout_value;
+    bool        rx_timed_out;
+
+    /* Container Messages: index of contained messages, keyed by mux_id. */
+    NetworkFrameIndex* mux_index;
+    size_t             mux_index_size;
 
     /* Message Functions. */
     NetworkFunction* encode_functions;  // NULL terminated list.
@@ -151,18 +249,102 @@ typedef struct NetworkMessage {
 
 
 typedef struct MarshalItem {
-    NetworkSignal*  signal;  // Set to NULL to end list.
-    NetworkMessage* message;
-    size_t          signal_vector_index;  // to signal vector on Network
+    NetworkSignal*     signal;  // Set to NULL to end list.
+    NetworkSignalInfo* info;    // Of the signal (names, init_value).
+    NetworkMessage*    message;
+    size_t             signal_vector_index;  // to signal vector on Network
+    size_t             plan_index;  // in the MarshalPlan group (signal type)
 } MarshalItem;
 
 
+/* Linear codec (codec.c), operates on the value array in-place. */
+typedef void (*NetworkLinearCodec)(size_t count, double* value,
+    const double* factor, const double* offset, const double* lower,
+    const double* upper, double* valid);
+
+
+/* Marshal Plan: MarshalItems compiled into contiguous arrays, grouped by
+NetworkSignalType, so that marshal loops avoid dependent pointer loads. */
+typedef struct MarshalGroup {
+    size_t    count;
+    size_t    linear_count;  // Items [0..linear_count) use the linear codec.
+    uint8_t** data;         // Message buffer + signal buffer_offset.
+    size_t*   index;        // to signal vector on Network
+    void**    encode_func;  // Typed according to the group.
+    void**    decode_func;
+    void**    range_func;
+    bool**    update;       // Message update_signals flag.
+    double**  constant;     // Internal container signals, otherwise NULL.
+    /* Linear codec parameters (raw bounds are exclusive). */
+    double*   factor;
+    double*   offset;
+    double*   lower;
+    double*   upper;
+    double*   value;  // Working storage.
+    double*   valid;
+} MarshalGroup;
+
+
+/* Slice of a MarshalGroup, the items [begin, end) of the type. */
+typedef struct MarshalSlice {
+    NetworkSignalType type;
+    uint32_t          begin;
+    uint32_t          end;
+} MarshalSlice;
+
+
+typedef struct MarshalPlan {
+    MarshalGroup       group[NETWORK_SIGNAL_TYPE__COUNT];
+    NetworkLinearCodec linear_encode;
+    NetworkLinearCodec linear_decode;
+    /* Change-driven TX (indexed by signal vector index). */
+    MarshalItem**      signal_item;     // Signal -> MarshalItem (and message).
+    uint64_t*          signal_changed;  // Bitmap.
+    /* Storage for the message marshal_index. */
+    uint32_t*          marshal_index;
+} MarshalPlan;
+
+
+/* Message index (open addressing), keyed by frame_id and frame_type (RX) or
+by mux_id (container messages). */
+typedef struct NetworkFrameIndex {
+    uint64_t        key;
+    NetworkMessage* message;  // NULL for an empty slot.
+} NetworkFrameIndex;
+
+
+#define NETWORK_SCHEDULE_RESOLUTION_US 1000 /* Default tick, 1 ms. */
+
+
 typedef struct NetworkScheduleItem {
     NetworkMessage* message;
-    uint32_t        alarm;
+    uint64_t        due;  // Tick of the next event (heap key).
+    uint32_t        heap_pos;
+    /* Cyclic alarm (periodic and mixed modes). */
+    uint64_t        cycle;  // Cycle time, ticks.
+    uint64_t        cycle_due;
+    /* Pending TX, a repetition or a TX deferred by the MDT. */
+    uint64_t        event_due;
+    uint32_t        repeat;      // Pending TX count.
+    uint64_t        repetition;  // Repetition period, ticks.
+    uint64_t        min_delay;   // MDT, ticks.
+    uint64_t        tx_tick;     // Tick of the last TX.
+    bool            tx_done;     // A TX was made (tx_tick is valid).
+    bool            tx_events;   // Cycle, MDT or repetitions configured.
+    /* RX deadline, rearmed on each RX. */
+    uint64_t        deadline_due;
+    uint64_t        timeout;  // RX timeout, ticks.
 } NetworkScheduleItem;
 
 
+/* Arena (bump allocator), holds the parser, loader and marshal objects of a
+Network. Released by network_unload(). */
+typedef struct NetworkArena {
+    NetworkArenaBlock* block;  // Current block (blocks are linked).
+    size_t             size;   // Total size of the blocks.
+} NetworkArena;
+
+
 typedef struct Network {
     const char*          name;
     YamlNode*            doc;
@@ -174,13 +356,23 @@ typedef struct Network {
     void*                function_lib_handle;
     /* Marshalling items. */
     MarshalItem*         marshal_list;  // NULL terminated list.
+    MarshalPlan*         marshal_plan;
+    NetworkMessage**     update_list;  // Messages to decode (this step).
+    size_t               update_count;
+    NetworkFrameIndex*   frame_index;       // RX lookup.
+    size_t               frame_index_size;  // Power of 2.
+    NetworkFrameIndex*   mux_index;         // Storage, container mux_index.
     /* Signal interface. */
     size_t               signal_count;
     const char**         signal_name;
     double*              signal_vector;
     /* Schedule. */
-    NetworkScheduleItem* schedule_list; /* NULL terminated list. */
-    uint32_t             tick;          /* 1 ms clock. */
+    NetworkScheduleItem* schedule_list;          /* NULL terminated list. */
+    uint32_t*            schedule_heap;          /* Min-heap (list index). */
+    size_t               schedule_count;         /* Items in schedule_heap. */
+    uint64_t             tick;                   /* Schedule clock. */
+    uint32_t             schedule_resolution_us; /* Tick period. */
+    bool                 schedule_phase_spread;  /* Spread unset phases. */
 
     /* Annotations. */
     uint32_t bus_id;
@@ -190,6 +382,28 @@ typedef struct Network {
     /* Sleep signal. */
     const char* netoff_signal;
     double*     netoff_value;
+
+    /* Network image (annotation network_image), mapped when valid. */
+    const char* image_path;
+    void*       image;
+    size_t      image_size;
+    uint64_t    image_key;
+
+    /* Lazy loading (annotation lazy_signals), when set only signals named
+    in the signal_filter (by signal_name), and internal/mux signals, are
+    loaded and marshalled. */
+    bool         lazy_signals;
+    const char** signal_filter;
+    size_t       signal_filter_count;
+
+    /* Message library descriptor (optional). */
+    const NetworkMessageDescriptor* descriptor;
+
+    /* Storage of the Network objects. */
+    NetworkArena arena;
+    /* Message buffers, shadow buffers and payloads (single slab). */
+    uint8_t*     buffer_slab;
+    size_t       buffer_slab_size;
 } Network;
 
 
@@ -205,9 +419,18 @@ DLL_PUBLIC int   network_load_signal_funcs(Network* n);
 DLL_PUBLIC void* network_load_function_lib(Network* n, const char* dll_path);
 DLL_PUBLIC int   network_load_function_funcs(Network* n);
 
+DLL_PRIVATE int  network_filter_signals(Network* n);
+DLL_PRIVATE int  network_signal_set_funcs(
+    NetworkSignal* ns, void* encode, void* decode, void* range);
+DLL_PRIVATE void network_signal_get_funcs(
+    NetworkSignal* ns, void** encode, void** decode, void** range);
+
 /* parser.c - Loads functions from the Network shared lib. */
 DLL_PUBLIC int network_parse(Network* n, ModelInstanceSpec* mi);
 DLL_PUBLIC int network_unload_parser(Network* n);
+DLL_PUBLIC NetworkSignalType network_signal_type(const char* member_type);
+
+DLL_PRIVATE int network_message_alloc_buffers(Network* n);
 
 /* engine.c - Loads functions from the Network shared lib. */
 DLL_PUBLIC int network_load_marshal_lists(Network* n);
@@ -216,23 +439,61 @@ DLL_PUBLIC int network_get_signal_names(
 DLL_PUBLIC int network_marshal_signals_to_messages(Network* n, MarshalItem* mi);
 DLL_PUBLIC int network_marshal_messages_to_signals(
     Network* n, MarshalItem* mi, bool signal);
+DLL_PUBLIC NetworkMessage* network_find_message(
+    Network* n, uint32_t frame_id, uint8_t frame_type);
+DLL_PUBLIC NetworkMessage* network_find_mux_message(
+    Network* n, NetworkMessage* container, uint32_t mux_id);
+DLL_PUBLIC void network_message_update(Network* n, NetworkMessage* nm);
+DLL_PUBLIC int  network_marshal_updated_messages(Network* n);
 DLL_PUBLIC void network_pack_messages(Network* n);
 DLL_PUBLIC void network_unpack_messages(Network* n);
+DLL_PUBLIC void network_signal_changed(Network* n, size_t index);
+DLL_PUBLIC void network_message_changed(Network* n, NetworkMessage* nm);
+DLL_PUBLIC void network_marshal_message(Network* n, NetworkMessage* nm);
+DLL_PUBLIC int  network_marshal_changed_signals(Network* n);
+DLL_PUBLIC void network_pack_changed_messages(Network* n);
 DLL_PUBLIC int  network_unload_marshal_lists(Network* n);
+DLL_PUBLIC int  network_load_marshal_plan(Network* n);
+DLL_PUBLIC int  network_unload_marshal_plan(Network* n);
+DLL_PRIVATE bool network_signal_linear(NetworkSignal* ns);
+
+/* codec.c */
+DLL_PRIVATE NetworkLinearCodec network_linear_encoder(void);
+DLL_PRIVATE NetworkLinearCodec network_linear_decoder(void);
+DLL_PRIVATE void               network_linear_bounds(
+    NetworkSignal* ns, double* lower, double* upper);
 
 /* encoder.c - Loads functions from the Network shared lib. */
-DLL_PRIVATE uint32_t simbus_generate_uid_hash(const uint8_t* key, size_t len);
-DLL_PUBLIC void      network_encode_to_bus(Network* n, void* nc);
-DLL_PUBLIC void      network_decode_from_bus(Network* n, void* nc);
+DLL_PUBLIC uint64_t network_hash64(const uint8_t* data, size_t len);
+DLL_PUBLIC bool     network_message_buffer_changed(NetworkMessage* nm);
+DLL_PUBLIC void     network_message_buffer_commit(NetworkMessage* nm);
+DLL_PUBLIC void     network_encode_to_bus(Network* n, void* nc);
+DLL_PUBLIC void     network_decode_from_bus(Network* n, void* nc);
 
 /* function.c */
 DLL_PUBLIC const char* network_function_annotation(
     NetworkFunction* function, const char* name);
-DLL_PUBLIC int network_function_apply_encode(Network* n);
-DLL_PUBLIC int network_function_apply_decode(Network* n);
+DLL_PUBLIC void network_function_modified(NetworkFunction* function);
+DLL_PUBLIC int  network_function_apply_encode(Network* n);
+DLL_PUBLIC int  network_function_apply_decode(Network* n);
+
+/* arena.c */
+DLL_PRIVATE void* network_arena_alloc(NetworkArena* a, size_t size);
+DLL_PRIVATE char* network_arena_strdup(NetworkArena* a, const char* s);
+DLL_PRIVATE void  network_arena_release(NetworkArena* a);
+
+/* image.c - Binary Network image (parsed messages and library symbols). */
+DLL_PRIVATE int network_image_load(Network* n);
+DLL_PRIVATE int network_image_resolve(Network* n);
+DLL_PRIVATE int network_image_save(Network* n);
+DLL_PRIVATE int network_image_unload(Network* n);
 
 /* schedule.c */
 DLL_PUBLIC void network_schedule_reset(Network* n);
 DLL_PUBLIC void network_schedule_tick(Network* n);
+DLL_PUBLIC void network_schedule_advance(Network* n, uint64_t ticks);
+DLL_PUBLIC void network_schedule_tx(Network* n, NetworkMessage* nm);
+DLL_PUBLIC void network_schedule_rx(Network* n, NetworkMessage* nm);
+DLL_PUBLIC NetworkTxMode network_tx_mode(NetworkMessage* nm);
 
 #endif  // DSE_NETWORK_NETWORK_H_
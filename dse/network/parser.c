@@ -3,7 +3,10 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <string.h>
+#include <strings.h>
+#include <stdio.h>
 #include <stdint.h>
+#include <math.h>
 #include <assert.h>
 #include <dlfcn.h>
 #include <dse/testing.h>
@@ -49,6 +52,154 @@ static uint32_t _get_uint32t(YamlNode* n, const char* p, bool err)
 }
 
 
+/* Time annotation, <p>_us has precedence over <p>_ms. */
+static uint32_t _get_time_us(YamlNode* n, const char* p)
+{
+    char path[100];
+    snprintf(path, sizeof(path), "%s_us", p);
+    uint32_t v = _get_uint32t(n, path, false);
+    if (v) return v;
+    snprintf(path, sizeof(path), "%s_ms", p);
+    return _get_uint32t(n, path, false) * 1000;
+}
+
+
+static const struct {
+    const char*   name;
+    NetworkTxMode mode;
+} __tx_mode_map[] = {
+    { "periodic", NETWORK_TX_MODE_PERIODIC },
+    { "direct", NETWORK_TX_MODE_DIRECT },
+    { "mixed", NETWORK_TX_MODE_MIXED },
+};
+
+
+static NetworkTxMode _get_tx_mode(YamlNode* n, const char* p)
+{
+    const char* mode = dse_yaml_get_scalar(n, p);
+    if (mode == NULL) return NETWORK_TX_MODE_DEFAULT;
+    for (size_t i = 0; i < ARRAY_SIZE(__tx_mode_map); i++) {
+        if (strcasecmp(mode, __tx_mode_map[i].name) == 0) {
+            return __tx_mode_map[i].mode;
+        }
+    }
+    log_error("Unknown TX mode: %s", mode);
+    return NETWORK_TX_MODE_DEFAULT;
+}
+
+
+static const struct {
+    const char*       name;
+    NetworkSignalType type;
+} __signal_type_map[] = {
+    { "int8_t", NETWORK_SIGNAL_TYPE_INT8 },
+    { "uint8_t", NETWORK_SIGNAL_TYPE_UINT8 },
+    { "int16_t", NETWORK_SIGNAL_TYPE_INT16 },
+    { "uint16_t", NETWORK_SIGNAL_TYPE_UINT16 },
+    { "int32_t", NETWORK_SIGNAL_TYPE_INT32 },
+    { "uint32_t", NETWORK_SIGNAL_TYPE_UINT32 },
+    { "int64_t", NETWORK_SIGNAL_TYPE_INT64 },
+    { "uint64_t", NETWORK_SIGNAL_TYPE_UINT64 },
+    { "float", NETWORK_SIGNAL_TYPE_FLOAT },
+    { "double", NETWORK_SIGNAL_TYPE_DOUBLE },
+};
+
+
+/* Resolve struct_member_primitive_type, marshal kernels select on the type. */
+NetworkSignalType network_signal_type(const char* member_type)
+{
+    if (member_type == NULL) return NETWORK_SIGNAL_TYPE_UNKNOWN;
+    for (size_t i = 0; i < ARRAY_SIZE(__signal_type_map); i++) {
+        if (strcmp(member_type, __signal_type_map[i].name) == 0) {
+            return __signal_type_map[i].type;
+        }
+    }
+    return NETWORK_SIGNAL_TYPE_UNKNOWN;
+}
+
+
+#define BUFFER_SLAB_ALIGN 64 /* Cache line. */
+#define BUFFER_ALIGN      8
+
+
+static size_t _buffer_align(size_t size)
+{
+    return (size + BUFFER_ALIGN - 1) & ~(size_t)(BUFFER_ALIGN - 1);
+}
+
+
+/* Allocate the buffers of all messages (buffer_len and payload_len are set)
+from a single slab. The struct buffer, shadow buffer and payload of each
+message are placed in message order, each with its exact size (aligned). */
+int network_message_alloc_buffers(Network* n)
+{
+    size_t size = 0;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        size += _buffer_align(nm->buffer_len) * 2;
+        size += _buffer_align(nm->payload_len);
+    }
+    if (size == 0) return 0;
+
+    size = (size + BUFFER_SLAB_ALIGN - 1) & ~(size_t)(BUFFER_SLAB_ALIGN - 1);
+    void* slab = NULL;
+    if (posix_memalign(&slab, BUFFER_SLAB_ALIGN, size) != 0) {
+        log_error("Message buffer allocation failed (size=%zu)", size);
+        return 1;
+    }
+    memset(slab, 0, size);
+    n->buffer_slab = slab;
+    n->buffer_slab_size = size;
+
+    uint8_t* p = n->buffer_slab;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        if (nm->buffer_len) {
+            nm->buffer = p;
+            p += _buffer_align(nm->buffer_len);
+            nm->buffer_shadow = p;
+            p += _buffer_align(nm->buffer_len);
+        }
+        if (nm->payload_len) {
+            nm->payload = p;
+            p += _buffer_align(nm->payload_len);
+        }
+    }
+    log_debug("Message buffers: %zu bytes", size);
+
+    return 0;
+}
+
+
+/* Scratch list of parsed items, copied to the arena when complete. */
+typedef struct ParseList {
+    uint8_t* items;
+    size_t   item_size;
+    size_t   count;
+    size_t   capacity;
+} ParseList;
+
+
+static void* _list_append(ParseList* l)
+{
+    if (l->count == l->capacity) {
+        l->capacity = l->capacity ? l->capacity * 2 : 16;
+        l->items = realloc(l->items, l->capacity * l->item_size);
+    }
+    void* item = l->items + l->count++ * l->item_size;
+    memset(item, 0, l->item_size);
+    return item;
+}
+
+
+/* Copy the list to the arena (NULL terminated) and release the list. */
+static void* _list_commit(Network* n, ParseList* l)
+{
+    void* list = network_arena_alloc(&n->arena, (l->count + 1) * l->item_size);
+    if (l->count) memcpy(list, l->items, l->count * l->item_size);
+    free(l->items);
+    return list;
+}
+
+
 static void* _message_object_generator(ModelInstanceSpec* mi, void* data)
 {
     UNUSED(mi);
@@ -77,39 +228,42 @@ static void* _signal_object_generator(ModelInstanceSpec* mi, void* data)
 }
 
 
-static void* _parse_signals(ModelInstanceSpec* mi, SchemaObject* object)
+static void _parse_signals(Network* n, ModelInstanceSpec* mi,
+    SchemaObject* object, NetworkMessage* msg)
 {
     uint32_t      index = 0;
     SignalObject* sig_obj;
-    HashList      s_list;
-    hashlist_init(&s_list, 100);
+    ParseList     s_list = { .item_size = sizeof(NetworkSignal) };
+    ParseList     i_list = { .item_size = sizeof(NetworkSignalInfo) };
 
     do {
         sig_obj = schema_object_enumerator(
             mi, object, "signals", &index, _signal_object_generator);
         if (sig_obj == NULL) break;
         if (sig_obj->signal) {
-            NetworkSignal* sig = calloc(1, sizeof(NetworkSignal));
-            sig->signal_name = strdup(sig_obj->signal);
+            NetworkSignal*     sig = _list_append(&s_list);
+            NetworkSignalInfo* si = _list_append(&i_list);
+            si->signal_name = network_arena_strdup(&n->arena, sig_obj->signal);
             /* struct_member_name */
-            sig->name = dse_yaml_get_scalar(
+            si->name = dse_yaml_get_scalar(
                 sig_obj->node, "annotations/struct_member_name");
-            log_debug("Scan match on name: %s", sig->name);
+            log_debug("Scan match on name: %s", si->name);
             /* struct_member_offset */
             sig->buffer_offset = _get_uint32t(
                 sig_obj->node, "annotations/struct_member_offset", true);
             /* struct_member_primitive_type */
-            sig->member_type = dse_yaml_get_scalar(
+            si->member_type = dse_yaml_get_scalar(
                 sig_obj->node, "annotations/struct_member_primitive_type");
-            if (sig->member_type) {
-                log_debug("Scan match on type: %s", sig->member_type);
+            if (si->member_type) {
+                log_debug("Scan match on type: %s", si->member_type);
             } else
                 log_error(
-                    "Missing struct_member_primitive_type for %s", sig->name);
+                    "Missing struct_member_primitive_type for %s", si->name);
+            sig->type = network_signal_type(si->member_type);
             /* init_value */
             dse_yaml_get_double(
-                sig_obj->node, "annotations/init_value", &sig->init_value);
-            log_debug("Scan match on init value: %f", sig->init_value);
+                sig_obj->node, "annotations/init_value", &si->init_value);
+            log_debug("Scan match on init value: %f", si->init_value);
             /* Container related (internal / value). */
             sig->internal = (bool)_get_uint32t(
                 sig_obj->node, "annotations/internal", false);
@@ -117,25 +271,26 @@ static void* _parse_signals(ModelInstanceSpec* mi, SchemaObject* object)
                 sig_obj->node, "annotations/value", &sig->value);
             sig->mux_signal = (bool)_get_uint32t(
                 sig_obj->node, "annotations/mux_signal", false);
-
-            /* Put the Network Message into a HashList (i.e. ordered) */
-            hashlist_append(&s_list, sig);
+            /* Linear scaling (factor/offset/minimum/maximum). */
+            sig->minimum = -INFINITY;
+            sig->maximum = INFINITY;
+            if (dse_yaml_get_double(sig_obj->node, "annotations/factor",
+                    &sig->factor) == 0 &&
+                sig->factor != 0.0) {
+                sig->linear = true;
+                dse_yaml_get_double(
+                    sig_obj->node, "annotations/offset", &sig->offset);
+                dse_yaml_get_double(
+                    sig_obj->node, "annotations/minimum", &sig->minimum);
+                dse_yaml_get_double(
+                    sig_obj->node, "annotations/maximum", &sig->maximum);
+            }
         }
         free(sig_obj);
     } while (1);
 
-    /* Convert the HashList to a NULL terminated list. */
-    size_t         count = hashlist_length(&s_list);
-    NetworkSignal* ns = calloc(count + 1, sizeof(NetworkSignal));
-    for (uint32_t i = 0; i < count; i++) {
-        memcpy(&ns[i], hashlist_at(&s_list, i), sizeof(NetworkSignal));
-        free(hashlist_at(&s_list, i));
-    }
-
-    /* Cleanup */
-    hashlist_destroy(&s_list);
-
-    return ns;
+    msg->signals = _list_commit(n, &s_list);
+    msg->signal_info = _list_commit(n, &i_list);
 }
 
 
@@ -153,13 +308,12 @@ static void* _function_object_generator(ModelInstanceSpec* mi, void* data)
 }
 
 
-static void* _parse_functions(
-    ModelInstanceSpec* mi, SchemaObject* object, const char* path)
+static void* _parse_functions(Network* n, ModelInstanceSpec* mi,
+    SchemaObject* object, const char* path)
 {
     uint32_t        index = 0;
     FunctionObject* func_obj;
-    HashList        f_list;
-    hashlist_init(&f_list, 100);
+    ParseList       f_list = { .item_size = sizeof(NetworkFunction) };
 
     do {
         func_obj = schema_object_enumerator(
@@ -167,41 +321,25 @@ static void* _parse_functions(
 
         if (func_obj == NULL) break;
         if (func_obj->function) {
-            NetworkFunction* func = calloc(1, sizeof(NetworkFunction));
-            func->name = strdup(func_obj->function);
+            NetworkFunction* func = _list_append(&f_list);
+            func->name = network_arena_strdup(&n->arena, func_obj->function);
             func->annotations =
                 dse_yaml_find_node(func_obj->node, "annotations");
             log_debug("Scan match on name: %s", func->name);
-
-            /* Put the Network Function into a HashList (i.e. ordered) */
-            hashlist_append(&f_list, func);
         }
         free(func_obj);
     } while (1);
 
-    /* Convert the HashList to a NULL terminated list. */
-    size_t           count = hashlist_length(&f_list);
-    NetworkFunction* nt_f = calloc(count + 1, sizeof(NetworkFunction));
-    for (uint32_t i = 0; i < count; i++) {
-        memcpy(&nt_f[i], hashlist_at(&f_list, i), sizeof(NetworkFunction));
-        free(hashlist_at(&f_list, i));
-    }
-
-    /* Cleanup */
-    hashlist_destroy(&f_list);
-
-    return nt_f;
+    return _list_commit(n, &f_list);
 }
 
 
-static void* _parse_messages(ModelInstanceSpec* mi, SchemaObject* object)
+static void* _parse_messages(
+    Network* n, ModelInstanceSpec* mi, SchemaObject* object)
 {
     uint32_t       index = 0;
     MessageObject* msg_obj;
-    HashList       m_list;
-    HashMap        m_map;
-    hashmap_init(&m_map);
-    hashlist_init(&m_list, 100);
+    ParseList      m_list = { .item_size = sizeof(NetworkMessage) };
 
     do {
         msg_obj = schema_object_enumerator(
@@ -209,7 +347,7 @@ static void* _parse_messages(ModelInstanceSpec* mi, SchemaObject* object)
         if (msg_obj == NULL) break;
 
         if (msg_obj->message) {
-            NetworkMessage* msg = calloc(1, sizeof(NetworkMessage));
+            NetworkMessage* msg = _list_append(&m_list);
 
             /* Message name */
             msg->name = dse_yaml_get_scalar(msg_obj->node, "message");
@@ -217,9 +355,6 @@ static void* _parse_messages(ModelInstanceSpec* mi, SchemaObject* object)
             /* Struct Size */
             msg->buffer_len =
                 _get_uint32t(msg_obj->node, "annotations/struct_size", true);
-            if (msg->buffer_len) {
-                msg->buffer = calloc(msg->buffer_len, sizeof(char*));
-            }
             /* Frame ID */
             const char* frame_id_str =
                 dse_yaml_get_scalar(msg_obj->node, "annotations/frame_id");
@@ -232,15 +367,41 @@ static void* _parse_messages(ModelInstanceSpec* mi, SchemaObject* object)
             /* Length */
             msg->payload_len =
                 _get_uint32t(msg_obj->node, "annotations/frame_length", true);
-            if (msg->payload_len) {
-                msg->payload = (char*)calloc(msg->payload_len, sizeof(char*));
-            }
             /* Type */
             msg->frame_type =
                 _get_uint32t(msg_obj->node, "annotations/frame_type", true);
-            /* Cycle Time */
+            /* Cycle Time (cycle_time_us, when set, has precedence). */
             msg->cycle_time_ms =
                 _get_uint32t(msg_obj->node, "annotations/cycle_time_ms", false);
+            msg->cycle_time_us =
+                _get_uint32t(msg_obj->node, "annotations/cycle_time_us", false);
+            if (msg->cycle_time_us == 0) {
+                msg->cycle_time_us = msg->cycle_time_ms * 1000;
+            }
+            /* Cycle Offset (phase). */
+            msg->cycle_offset_us =
+                _get_time_us(msg_obj->node, "annotations/cycle_offset");
+            /* Transmission Mode. */
+            msg->tx_mode = _get_tx_mode(msg_obj->node, "annotations/tx_mode");
+            msg->tx_min_delay_us =
+                _get_time_us(msg_obj->node, "annotations/tx_min_delay");
+            msg->tx_repetitions = _get_uint32t(
+                msg_obj->node, "annotations/tx_repetitions", false);
+            msg->tx_repetition_us =
+                _get_time_us(msg_obj->node, "annotations/tx_repetition_period");
+            /* RX Deadline (timeout, or a number of cycles). */
+            msg->rx_timeout_us =
+                _get_time_us(msg_obj->node, "annotations/rx_timeout");
+            if (msg->rx_timeout_us == 0) {
+                uint32_t cycles = _get_uint32t(
+                    msg_obj->node, "annotations/rx_timeout_cycles", false);
+                msg->rx_timeout_us = cycles * msg->cycle_time_us;
+            }
+            dse_yaml_get_bool(msg_obj->node,
+                "annotations/rx_timeout_substitute",
+                &msg->rx_timeout_substitute);
+            dse_yaml_get_string(msg_obj->node,
+                "annotations/rx_timeout_signal", &msg->rx_timeout_signal);
             /* Container */
             dse_yaml_get_string(
                 msg_obj->node, "annotations/container", &msg->container);
@@ -250,34 +411,20 @@ static void* _parse_messages(ModelInstanceSpec* mi, SchemaObject* object)
                 msg_obj->node, "annotations/container_mux_id", false);
 
             /* Parse Signals */
-            msg->signals =
-                _parse_signals(mi, &(SchemaObject){ .doc = msg_obj->node });
+            _parse_signals(
+                n, mi, &(SchemaObject){ .doc = msg_obj->node }, msg);
 
             /* Parse Functions */
-            msg->encode_functions = _parse_functions(mi,
+            msg->encode_functions = _parse_functions(n, mi,
                 &(SchemaObject){ .doc = msg_obj->node }, "functions/encode");
-            msg->decode_functions = _parse_functions(mi,
+            msg->decode_functions = _parse_functions(n, mi,
                 &(SchemaObject){ .doc = msg_obj->node }, "functions/decode");
-
-            hashlist_append(&m_list, msg);
-            hashmap_set(&m_map, frame_id_str, msg);
         }
 
         free(msg_obj);
     } while (1);
 
-    /* Convert the HashList to a NULL terminated list. */
-    size_t          count = hashlist_length(&m_list);
-    NetworkMessage* nm_p = calloc(count + 1, sizeof(NetworkMessage));
-    for (uint32_t i = 0; i < count; i++) {
-        memcpy(&nm_p[i], hashlist_at(&m_list, i), sizeof(NetworkMessage));
-        free(hashlist_at(&m_list, i));
-    }
-
-    /* Cleanup */
-    hashlist_destroy(&m_list);
-    hashmap_destroy(&m_map);
-    return nm_p;
+    return _list_commit(n, &m_list);
 }
 
 
@@ -312,9 +459,31 @@ static int _network_match_handler(ModelInstanceSpec* mi, SchemaObject* object)
     dse_yaml_get_uint(n->doc, "metadata/annotations/bus_id", &value);
     n->bus_id = value;
     log_debug("Scan match on bus id: %u", value);
+    /* Schedule Resolution */
+    value = NETWORK_SCHEDULE_RESOLUTION_US;
+    dse_yaml_get_uint(
+        n->doc, "metadata/annotations/schedule_resolution_us", &value);
+    n->schedule_resolution_us = value;
+    log_debug("Schedule resolution (us): %u", value);
+    /* Schedule Phase Spread */
+    dse_yaml_get_bool(n->doc, "metadata/annotations/schedule_phase_spread",
+        &n->schedule_phase_spread);
+    log_debug("Schedule phase spread: %d", n->schedule_phase_spread);
+    /* Lazy Signals */
+    dse_yaml_get_bool(
+        n->doc, "metadata/annotations/lazy_signals", &n->lazy_signals);
+    log_debug("Lazy signals: %d", n->lazy_signals);
+    /* Network Image */
+    dse_yaml_get_string(
+        n->doc, "metadata/annotations/network_image", &n->image_path);
+    log_debug("Network Image: %s", n->image_path);
 
-    /* Enumerate over the messages of the Network doc. */
-    n->messages = _parse_messages(mi, object);
+    /* Enumerate over the messages of the Network doc (or map the image). */
+    if (network_image_load(n) != 0) {
+        n->messages = _parse_messages(n, mi, object);
+    }
+    /* Buffers (struct and payload) of all messages. */
+    network_message_alloc_buffers(n);
 
     return 0;
 }
@@ -337,31 +506,11 @@ int network_parse(Network* n, ModelInstanceSpec* mi)
 }
 
 
-static void _free_message(NetworkMessage* message)
-{
-    if (message) {
-        if (message->buffer) free(message->buffer);
-        if (message->payload) free(message->payload);
-    }
-}
-
-
-static void _free_signals(NetworkSignal* signals)
-{
-    for (NetworkSignal* ns = signals; ns && ns->signal_name; ns++) {
-        free(ns->signal_name);
-    }
-    if (signals) free(signals);
-}
-
-
 static void _free_functions(NetworkFunction* functions)
 {
     for (NetworkFunction* nf = functions; nf && nf->name; nf++) {
-        free(nf->name);
         if (nf->data) free(nf->data);
     }
-    if (functions) free(functions);
 }
 
 
@@ -369,13 +518,16 @@ int network_unload_parser(Network* n)
 {
     if (n == NULL) return 0;
 
+    /* Messages, signals and functions are held by the arena. */
     for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
-        _free_signals(nm->signals);
-        _free_message(nm);
         _free_functions(nm->encode_functions);
         _free_functions(nm->decode_functions);
     }
-    if (n->messages) free(n->messages);
+    n->messages = NULL;
+    /* Message buffers are held by the slab. */
+    if (n->buffer_slab) free(n->buffer_slab);
+    n->buffer_slab = NULL;
+    n->buffer_slab_size = 0;
 
     return 0;
 }
@@ -13,67 +13,319 @@
 #include <dse/clib/util/yaml.h>
 
 
+/* Scheduled messages are kept in a binary min-heap keyed on the (absolute)
+tick of their next event, each tick only visits the messages which are due.
+The tick period is schedule_resolution_us (default 1 ms), message cycle
+times (cycle_time_us) are converted to ticks when the schedule is reset.
+
+Transmission modes (AUTOSAR COM) are implemented with two events for each
+message: the cyclic alarm (periodic and mixed modes) and a pending TX, which
+is either a repetition of a direct TX or a TX deferred by the minimum delay
+time (MDT). A TX is made at the last tick of the advance (i.e. the step).
+
+RX deadline monitoring adds a third event, the deadline, which is rearmed
+on each RX (network_schedule_rx) and fires if no frame was received within
+the timeout. */
+
+#define SCHEDULE_NEVER UINT64_MAX
+#define HEAP_NONE      UINT32_MAX
+
+
+static uint64_t _heap_due(Network* n, size_t i)
+{
+    return n->schedule_list[n->schedule_heap[i]].due;
+}
+
+
+static void _heap_swap(Network* n, size_t i, size_t j)
+{
+    uint32_t* heap = n->schedule_heap;
+    uint32_t  t = heap[i];
+    heap[i] = heap[j];
+    heap[j] = t;
+    n->schedule_list[heap[i]].heap_pos = i;
+    n->schedule_list[heap[j]].heap_pos = j;
+}
+
+
+static size_t _schedule_sift_up(Network* n, size_t i)
+{
+    while (i) {
+        size_t p = (i - 1) / 2;
+        if (_heap_due(n, p) <= _heap_due(n, i)) break;
+        _heap_swap(n, i, p);
+        i = p;
+    }
+    return i;
+}
+
+
+static void _schedule_sift_down(Network* n, size_t i)
+{
+    size_t count = n->schedule_count;
+    for (;;) {
+        size_t min = i;
+        size_t l = 2 * i + 1;
+        size_t r = l + 1;
+        if (l < count && _heap_due(n, l) < _heap_due(n, min)) min = l;
+        if (r < count && _heap_due(n, r) < _heap_due(n, min)) min = r;
+        if (min == i) break;
+        _heap_swap(n, i, min);
+        i = min;
+    }
+}
+
+
+/* Set the due tick of an item (from its events) and restore the heap. Items
+without events are removed from the heap (and added again when needed). */
+static void _schedule_update(Network* n, NetworkScheduleItem* nsi)
+{
+    nsi->due = nsi->cycle_due;
+    if (nsi->event_due < nsi->due) nsi->due = nsi->event_due;
+    if (nsi->deadline_due < nsi->due) nsi->due = nsi->deadline_due;
+
+    size_t pos = nsi->heap_pos;
+    if (pos == HEAP_NONE) {
+        if (nsi->due == SCHEDULE_NEVER) return;
+        pos = n->schedule_count++;
+        n->schedule_heap[pos] = nsi - n->schedule_list;
+        nsi->heap_pos = pos;
+    } else if (nsi->due == SCHEDULE_NEVER) {
+        nsi->heap_pos = HEAP_NONE;
+        if (pos == --n->schedule_count) return;
+        n->schedule_heap[pos] = n->schedule_heap[n->schedule_count];
+        n->schedule_list[n->schedule_heap[pos]].heap_pos = pos;
+    }
+    _schedule_sift_down(n, _schedule_sift_up(n, pos));
+}
+
+
+/* Request a TX at tick t, made at tick now. Returns false if the TX was
+deferred by the MDT (to a pending TX). */
+static bool _schedule_request_tx(
+    NetworkScheduleItem* nsi, uint64_t t, uint64_t now)
+{
+    if (nsi->tx_done && t < nsi->tx_tick + nsi->min_delay) {
+        uint64_t due = nsi->tx_tick + nsi->min_delay;
+        if (due < nsi->event_due) nsi->event_due = due;
+        return false;
+    }
+    NetworkMessage* nm = nsi->message;
+    if (network_tx_mode(nm) == NETWORK_TX_MODE_PERIODIC) {
+        /* Invalidate the shadow buffer, the message will TX (in this mode
+        changes to the buffer do not cause a TX). */
+        nm->buffer_shadow_valid = false;
+    }
+    nm->needs_tx = true;
+    nsi->tx_tick = now;
+    nsi->tx_done = true;
+    return true;
+}
+
+
+static void _schedule_rx_timeout(Network* n, NetworkMessage* nm)
+{
+    log_debug("RX timeout (message=%s)", nm->name);
+    nm->rx_timed_out = true;
+    if (nm->rx_timeout_value) *nm->rx_timeout_value = 1.0;
+    if (nm->rx_timeout_substitute) {
+        for (size_t i = 0; i < nm->marshal_count; i++) {
+            MarshalItem* mi = &nm->marshal_items[i];
+            if (mi->signal->internal) continue;
+            n->signal_vector[mi->signal_vector_index] = mi->info->init_value;
+        }
+        /* Marshal the substituted values to the buffer (which still holds
+        the last RX) and commit, the message is received (not sent) so no
+        TX is raised. The next RX differs from the shadow and is decoded. */
+        network_marshal_message(n, nm);
+        network_message_buffer_commit(nm);
+    }
+}
+
+
+static uint64_t _to_ticks(Network* n, uint32_t us)
+{
+    uint32_t resolution = n->schedule_resolution_us;
+    return (us + resolution / 2) / resolution;
+}
+
+
+static bool _is_scheduled(NetworkMessage* nm)
+{
+    return (nm->cycle_time_us || nm->tx_min_delay_us || nm->tx_repetitions ||
+            nm->rx_timeout_us);
+}
+
+
+NetworkTxMode network_tx_mode(NetworkMessage* nm)
+{
+    if (nm->tx_mode != NETWORK_TX_MODE_DEFAULT) return nm->tx_mode;
+    return nm->cycle_time_us ? NETWORK_TX_MODE_PERIODIC
+                             : NETWORK_TX_MODE_DIRECT;
+}
+
+
 void network_schedule_reset(Network* n)
 {
     if (n->messages == NULL) return;
 
     if (n->schedule_list) free(n->schedule_list);
-    HashList n_list;
-    hashlist_init(&n_list, 100);
-
+    if (n->schedule_heap) free(n->schedule_heap);
+    if (n->schedule_resolution_us == 0) {
+        n->schedule_resolution_us = NETWORK_SCHEDULE_RESOLUTION_US;
+    }
+    size_t count = 0;
     for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
-        if (nm->cycle_time_ms) {
-            NetworkScheduleItem* nsi = calloc(1, sizeof(NetworkScheduleItem));
-            nsi->message = nm;
-            hashlist_append(&n_list, nsi);
-        }
+        nm->schedule_item = NULL;
+        nm->rx_timed_out = false;
+        if (_is_scheduled(nm)) count++;
     }
-    size_t count = hashlist_length(&n_list);
     n->schedule_list = calloc(count + 1, sizeof(NetworkScheduleItem));
-    for (uint32_t i = 0; i < count; i++) {
-        memcpy(&n->schedule_list[i], hashlist_at(&n_list, i),
-            sizeof(NetworkScheduleItem));
-        free(hashlist_at(&n_list, i));
+    n->schedule_heap = calloc(count + 1, sizeof(uint32_t));
+    n->schedule_count = 0;
+
+    /* Alarms fire on the ticks which are at the phase (offset) of the
+    cycle, except tick 0 (i.e. without an offset, the first alarm is one cycle
+    after tick 0). With phase spread, messages without an offset are given
+    consecutive phases so that their alarms do not fire on the same tick. */
+    NetworkScheduleItem* nsi = n->schedule_list;
+    uint64_t             spread = 0;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        if (_is_scheduled(nm) == false) continue;
+        nsi->message = nm;
+        nsi->heap_pos = HEAP_NONE;
+        nsi->cycle_due = SCHEDULE_NEVER;
+        nsi->event_due = SCHEDULE_NEVER;
+        nsi->deadline_due = SCHEDULE_NEVER;
+        nsi->tx_events = (nm->cycle_time_us || nm->tx_min_delay_us ||
+                          nm->tx_repetitions);
+        nsi->min_delay = _to_ticks(n, nm->tx_min_delay_us);
+        nsi->repetition = _to_ticks(n, nm->tx_repetition_us);
+        if (nsi->repetition == 0) nsi->repetition = 1;
+        nm->schedule_item = nsi;
+        NetworkTxMode mode = network_tx_mode(nm);
+        if (nm->cycle_time_us && mode != NETWORK_TX_MODE_DIRECT) {
+            uint32_t resolution = n->schedule_resolution_us;
+            uint64_t cycle = _to_ticks(n, nm->cycle_time_us);
+            uint64_t offset = _to_ticks(n, nm->cycle_offset_us);
+            if (cycle == 0) cycle = 1;
+            if (cycle * resolution != nm->cycle_time_us) {
+                log_error("Cycle time %u us not on schedule resolution %u us "
+                          "(message=%s), using %llu us",
+                    nm->cycle_time_us, resolution, nm->name,
+                    (unsigned long long)(cycle * resolution));
+            }
+            if (offset == 0 && n->schedule_phase_spread) {
+                offset = spread++ % cycle;
+            }
+            nsi->cycle = cycle;
+            nsi->cycle_due = offset ? offset : cycle;
+        }
+        if (nm->rx_timeout_us) {
+            /* The first deadline is from tick 0. */
+            nsi->timeout = _to_ticks(n, nm->rx_timeout_us);
+            if (nsi->timeout == 0) nsi->timeout = 1;
+            nsi->deadline_due = nsi->timeout;
+        }
+        _schedule_update(n, nsi);
+        nsi++;
     }
-    hashlist_destroy(&n_list);
 
     /* Reset the tick counter. */
     n->tick = 0;
 }
 
 
-void network_schedule_tick(Network* n)
+void network_schedule_advance(Network* n, uint64_t ticks)
 {
+    if (ticks == 0) return;
     if (n->schedule_list == NULL) {
         /* Caller forgot to call runnable_schedule_reset()? */
         log_error("No scheduled tasks!");
-        n->tick++; /* Tick so caller does not hang. */
+        n->tick += ticks; /* Tick so caller does not hang. */
         return;
     }
-    /* Current tick. */
-    for (NetworkScheduleItem* nsi = n->schedule_list; nsi && nsi->message;
-        nsi++) {
-        if (n->tick == 0) {
-        } else {
-            /* Decrement the alarm counter. */
-            if (nsi->alarm) {
-                nsi->alarm--;
-                /* Transition to 0? */
-                if (nsi->alarm == 0) {
-                    /* Alarm fired, reset checksum.*/
-                    if (nsi->message->cycle_time_ms) {
-                        nsi->message->buffer_checksum = 0;
-                        nsi->message->needs_tx = true;
-                    }
-                }
+
+    /* Process the events which are due in the ticks [tick, last]. An alarm
+    which would fire several times in that range fires once, and is then
+    re-armed at the first multiple of the cycle time after last. */
+    uint64_t last = n->tick + ticks - 1;
+    while (n->schedule_count && _heap_due(n, 0) <= last) {
+        NetworkScheduleItem* nsi = &n->schedule_list[n->schedule_heap[0]];
+        NetworkMessage*      nm = nsi->message;
+        if (nsi->cycle_due <= last) {
+            if (nm->cycle_time_us == 0) {
+                /* Cycle time was removed, drop the alarm. */
+                nsi->cycle_due = SCHEDULE_NEVER;
+            } else {
+                /* Alarm fired. */
+                _schedule_request_tx(nsi, nsi->cycle_due, last);
+                nsi->cycle_due +=
+                    nsi->cycle * ((last - nsi->cycle_due) / nsi->cycle + 1);
             }
         }
-        /* Reset the alarm counter. */
-        if (nsi->alarm == 0) {
-            nsi->alarm = nsi->message->cycle_time_ms;
+        if (nsi->deadline_due <= last) {
+            /* No RX within the timeout. */
+            nsi->deadline_due = SCHEDULE_NEVER;
+            _schedule_rx_timeout(n, nm);
         }
+        if (nsi->event_due <= last) {
+            /* Pending TX, when made schedule the next repetition. */
+            uint64_t t = nsi->event_due;
+            nsi->event_due = SCHEDULE_NEVER;
+            if (_schedule_request_tx(nsi, t, last)) {
+                if (nsi->repeat) nsi->repeat--;
+                if (nsi->repeat) nsi->event_due = last + nsi->repetition;
+            }
+        }
+        _schedule_update(n, nsi);
     }
 
     /* Next tick. */
-    n->tick++;
+    n->tick += ticks;
+}
+
+
+void network_schedule_tick(Network* n)
+{
+    network_schedule_advance(n, 1);
+}
+
+
+/* Request a direct TX (i.e. the message changed). The TX is made at the
+current tick (the last tick of the previous advance), or deferred by the
+MDT. The configured repetitions follow the TX. */
+void network_schedule_tx(Network* n, NetworkMessage* nm)
+{
+    NetworkScheduleItem* nsi = nm->schedule_item;
+    if (nsi == NULL) {
+        nm->needs_tx = true;
+        return;
+    }
+
+    uint64_t now = n->tick ? n->tick - 1 : 0;
+    nsi->repeat = nm->tx_repetitions;
+    nsi->event_due = SCHEDULE_NEVER;
+    if (_schedule_request_tx(nsi, now, now)) {
+        if (nsi->repeat) nsi->event_due = now + nsi->repetition;
+    } else {
+        nsi->repeat++; /* The deferred TX. */
+    }
+    _schedule_update(n, nsi);
+}
+
+
+/* Rearm the RX deadline of a message (i.e. a frame was received). The frame
+is received at the current tick (the next tick of the schedule). */
+void network_schedule_rx(Network* n, NetworkMessage* nm)
+{
+    NetworkScheduleItem* nsi = nm->schedule_item;
+    if (nsi == NULL || nsi->timeout == 0) return;
+
+    if (nm->rx_timed_out) {
+        nm->rx_timed_out = false;
+        if (nm->rx_timeout_value) *nm->rx_timeout_value = 0.0;
+    }
+    nsi->deadline_due = n->tick + nsi->timeout;
+    _schedule_update(n, nsi);
 }
@@ -97,6 +97,9 @@ def scan_messages(dbc_file, out_path, frame_filter, cycle_time):
             'is_extended_frame': message.is_extended_frame,
             'is_container': is_container
         }
+        frames[message_name]['signal_scaling'] = {
+            camel_to_snake_case(s.name): signal_scaling(s) for s in message.signals
+        }
         if str(message.frame_id) in cycle_time.keys():
             frames[message_name]['cycle_time_ms'] = int(cycle_time[str(message.frame_id)])
         if is_container:
@@ -109,13 +112,202 @@ def scan_messages(dbc_file, out_path, frame_filter, cycle_time):
                     'cycle_time_ms': int(message.cycle_time) if message.cycle_time else None,
                     'is_can_fd': message.is_fd,
                     'is_extended_frame': message.is_extended_frame,
-                    'signals' : [camel_to_snake_case(s) for s in signals]
+                    'signals' : [camel_to_snake_case(s) for s in signals],
+                    'signal_scaling': {
+                        camel_to_snake_case(s.name): signal_scaling(s)
+                        for s in message.signals
+                        if s.name in signals
+                    }
                 }
 
     with open(outfile, 'w') as f:
         yaml.dump({'frames': frames}, f)
 
 
+def signal_scaling(signal):
+    # Linear scaling of the signal, used by the native codec of the Network
+    # Model. Integer signals always have a range which is limited by the
+    # signal length (i.e. the raw range checked by <signal>_is_in_range).
+    scaling = {
+        'factor': float(signal.scale),
+        'offset': float(signal.offset),
+    }
+    has_range = (signal.minimum is not None and signal.maximum is not None
+                 and signal.minimum != signal.maximum)
+    if signal.is_float:
+        if has_range:
+            scaling['minimum'] = float(signal.minimum)
+            scaling['maximum'] = float(signal.maximum)
+        return scaling
+
+    if signal.is_signed:
+        raw_limits = (-(2 ** (signal.length - 1)), 2 ** (signal.length - 1) - 1)
+    else:
+        raw_limits = (0, 2 ** signal.length - 1)
+    limits = sorted(r * signal.scale + signal.offset for r in raw_limits)
+    minimum, maximum = limits
+    if has_range:
+        minimum = max(minimum, signal.minimum)
+        maximum = min(maximum, signal.maximum)
+    scaling['minimum'] = float(minimum)
+    scaling['maximum'] = float(maximum)
+    return scaling
+
+
+def c_type_name(signal):
+    # Type of the struct member (as generated by cantools).
+    if signal.is_float:
+        return 'float' if signal.length == 32 else 'double'
+    for type_length in (8, 16, 32, 64):
+        if signal.length <= type_length:
+            break
+    type_name = f'int{type_length}_t'
+    return type_name if signal.is_signed else 'u' + type_name
+
+
+def load_database(args):
+    db = cantools.database.load_file(args.infile, encoding=args.encoding,
+                                     strict=not args.no_strict)
+    if args.database_name is None:
+        database_name = os.path.splitext(os.path.basename(args.infile))[0]
+        database_name = camel_to_snake_case(database_name)
+    else:
+        database_name = args.database_name
+    path_c = os.path.join(args.output_directory, database_name + '.c')
+    return db, database_name, path_c
+
+
+def has_marshal_source(message):
+    return not (message.is_container or message.is_multiplexed())
+
+
+def generate_marshal_source(args):
+    # Fused marshal functions, appended to the generated C source. The Network
+    # Model calls these (when present) in place of the per signal functions:
+    #   <db>_<msg>_marshal_signals : NULL terminated list of struct members
+    #   <db>_<msg>_marshal_tx : sv[idx[i]] -> encode -> range check -> struct
+    #   <db>_<msg>_marshal_rx : struct -> range check -> decode -> sv[idx[i]]
+    if args.no_floating_point_numbers or args.node:
+        # Encode/decode functions are not (all) generated.
+        return
+    db, database_name, path_c = load_database(args)
+
+    lines = [
+        '',
+        '/* Fused marshal functions (generated by gencode.py). */',
+    ]
+    for message in db.messages:
+        if not has_marshal_source(message):
+            continue
+        prefix = f'{database_name}_{camel_to_snake_case(message.name)}'
+        members = [camel_to_snake_case(s.name) for s in message.signals]
+        lines += ['', f'const char* {prefix}_marshal_signals[] = {{']
+        lines += [f'    "{m}",' for m in members]
+        lines += ['    NULL,', '};', '']
+        lines += [
+            f'void {prefix}_marshal_tx(',
+            '    const double* sv, const uint32_t* idx, void* buffer)',
+            '{',
+            f'    struct {prefix}_t* msg_p = buffer;',
+        ]
+        for i, (signal, m) in enumerate(zip(message.signals, members)):
+            lines += [
+                '    {',
+                f'        {c_type_name(signal)} value = '
+                f'{prefix}_{m}_encode(sv[idx[{i}]]);',
+                f'        if ({prefix}_{m}_is_in_range(value)) '
+                f'msg_p->{m} = value;',
+                '    }',
+            ]
+        lines += ['}', '']
+        lines += [
+            f'void {prefix}_marshal_rx(',
+            '    double* sv, const uint32_t* idx, const void* buffer)',
+            '{',
+            f'    const struct {prefix}_t* msg_p = buffer;',
+        ]
+        for i, m in enumerate(members):
+            lines += [
+                f'    if ({prefix}_{m}_is_in_range(msg_p->{m})) {{',
+                f'        sv[idx[{i}]] = {prefix}_{m}_decode(msg_p->{m});',
+                '    }',
+            ]
+        lines += ['}']
+
+    with open(path_c, 'a') as f:
+        f.write('\n'.join(lines) + '\n')
+
+
+def generate_descriptor_source(args):
+    # Network descriptor, appended to the generated C source. The Network
+    # Model loads the message and signal functions from this table with a
+    # single symbol lookup (<db>_network_descriptor), the layout of the table
+    # matches NetworkMessageDescriptor and NetworkSignalDescriptor (network.h).
+    if args.no_floating_point_numbers or args.node:
+        # Encode/decode functions are not (all) generated.
+        return
+    db, database_name, path_c = load_database(args)
+
+    lines = [
+        '',
+        '/* Network descriptor (generated by gencode.py). */',
+        '',
+        f'struct {database_name}_signal_descriptor {{',
+        '    const char* name;',
+        '    void*       encode;',
+        '    void*       decode;',
+        '    void*       range;',
+        '};',
+        '',
+        f'struct {database_name}_message_descriptor {{',
+        '    const char*  name;',
+        '    void*        pack;',
+        '    void*        unpack;',
+        f'    const struct {database_name}_signal_descriptor* signals;',
+        '    const char** marshal_signals;',
+        '    void*        marshal_tx;',
+        '    void*        marshal_rx;',
+        '};',
+    ]
+    messages = []
+    for message in db.messages:
+        message_name = camel_to_snake_case(message.name)
+        prefix = f'{database_name}_{message_name}'
+        lines += [
+            '',
+            f'static const struct {database_name}_signal_descriptor '
+            f'{prefix}_signal_descriptor[] = {{',
+        ]
+        for signal in message.signals:
+            s = f'{prefix}_{camel_to_snake_case(signal.name)}'
+            lines += [
+                f'    {{ "{camel_to_snake_case(signal.name)}", '
+                f'(void*){s}_encode, (void*){s}_decode, '
+                f'(void*){s}_is_in_range }},'
+            ]
+        lines += ['    { NULL },', '};']
+        marshal = ['NULL', 'NULL', 'NULL']
+        if has_marshal_source(message):
+            marshal = [f'{prefix}_marshal_signals',
+                       f'(void*){prefix}_marshal_tx',
+                       f'(void*){prefix}_marshal_rx']
+        messages += [
+            f'    {{ "{message_name}", (void*){prefix}_pack, '
+            f'(void*){prefix}_unpack, {prefix}_signal_descriptor, '
+            f'{", ".join(marshal)} }},'
+        ]
+    lines += [
+        '',
+        f'const struct {database_name}_message_descriptor '
+        f'{database_name}_network_descriptor[] = {{',
+    ]
+    lines += messages
+    lines += ['    { NULL },', '};']
+
+    with open(path_c, 'a') as f:
+        f.write('\n'.join(lines) + '\n')
+
+
 def camel_to_snake_case(value):
     value = re.sub(r'(.)([A-Z][a-z]+)', r'\1_\2', value)
     value = re.sub(r'(_+)', '_', value)
@@ -127,6 +319,8 @@ def camel_to_snake_case(value):
 def main():
     args = parse_arguments()
     _do_generate_c_source(args)
+    generate_marshal_source(args)
+    generate_descriptor_source(args)
     scan_messages(args.infile, args.output_directory, args.filter, args.cycle_time)
 
 
@@ -148,6 +148,7 @@ func (c *GenNetworkCommand) Run() error {
 				annotations["struct_member_name"] = s.Name
 				annotations["struct_member_offset"] = offset
 				annotations["struct_member_primitive_type"] = s.TypeName
+				setScalingAnnotations(annotations, frameInfo, s.Name)
 				signal.Annotations = &annotations
 				signals = append(signals, signal)
 			}
@@ -178,15 +179,23 @@ func (c *GenNetworkCommand) Run() error {
 }
 
 type FrameInfo struct {
-	FrameId        int      `yaml:"frame_id"`
-	FrameLength    int      `yaml:"frame_length"`
-	CycleTime      int      `yaml:"cycle_time_ms"`
-	CanFD          bool     `yaml:"is_can_fd"`
-	ExtendedFrame  bool     `yaml:"is_extended_frame"`
-	Container      string   `yaml:"container"`
-	ContainerMuxId int      `yaml:"container_mux_id"`
-	IsContainer    bool     `yaml:"is_container"`
-	Signals        []string `yaml:"signals"`
+	FrameId        int                      `yaml:"frame_id"`
+	FrameLength    int                      `yaml:"frame_length"`
+	CycleTime      int                      `yaml:"cycle_time_ms"`
+	CanFD          bool                     `yaml:"is_can_fd"`
+	ExtendedFrame  bool                     `yaml:"is_extended_frame"`
+	Container      string                   `yaml:"container"`
+	ContainerMuxId int                      `yaml:"container_mux_id"`
+	IsContainer    bool                     `yaml:"is_container"`
+	Signals        []string                 `yaml:"signals"`
+	SignalScaling  map[string]SignalScaling `yaml:"signal_scaling"`
+}
+
+type SignalScaling struct {
+	Factor  float64  `yaml:"factor"`
+	Offset  float64  `yaml:"offset"`
+	Minimum *float64 `yaml:"minimum"`
+	Maximum *float64 `yaml:"maximum"`
 }
 
 type FrameMetadata struct {
@@ -215,6 +224,19 @@ func findFrameInfo(fmd *FrameMetadata, name string, dbc string) *FrameInfo {
 	return nil
 }
 
+func setScalingAnnotations(annotations kind.Annotations, f *FrameInfo, memberName string) {
+	scaling, ok := f.SignalScaling[memberName]
+	if !ok {
+		return
+	}
+	annotations["factor"] = scaling.Factor
+	annotations["offset"] = scaling.Offset
+	if scaling.Minimum != nil && scaling.Maximum != nil {
+		annotations["minimum"] = *scaling.Minimum
+		annotations["maximum"] = *scaling.Maximum
+	}
+}
+
 func getMessageName(structName string, dbcName string) string {
 	dbcName = strings.ToLower(dbcName)
 	name := structName[:len(structName)-2]
@@ -304,6 +326,7 @@ func processContainer(net *kind.Network, message kind.NetworkMessage, fmd *Frame
 						annotations["internal"] = "true"
 						annotations["value"] = frameInfo.FrameLength
 					}
+					setScalingAnnotations(annotations, &frameInfo, s.Name)
 					signal.Annotations = &annotations
 					signals = append(signals, signal)
 				}
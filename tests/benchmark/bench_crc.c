@@ -0,0 +1,99 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <dse/network/functions/crc.h>
+
+
+struct timespec get_timespec_now(void)
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts;
+}
+
+
+uint64_t get_elapsedtime_ns(struct timespec ref)
+{
+    struct timespec now = get_timespec_now();
+    if (ref.tv_sec == now.tv_sec) {
+        return now.tv_nsec - ref.tv_nsec;
+    } else {
+        return ((now.tv_sec - ref.tv_sec) * 1000000000) +
+               (now.tv_nsec - ref.tv_nsec);
+    }
+}
+
+
+static const char* crc_names[] = {
+    [NETWORK_CRC8_SAE_J1850] = "CRC8",
+    [NETWORK_CRC8H2F] = "CRC8H2F",
+    [NETWORK_CRC16_CCITT] = "CRC16",
+    [NETWORK_CRC32] = "CRC32",
+    [NETWORK_CRC32P4] = "CRC32P4",
+};
+
+
+void run_bench_crc(const char* name, NetworkCrcImpl impl, NetworkCrcType type,
+    uint8_t* data, size_t len)
+{
+    /* Roughly the same amount of data for each payload length. */
+    size_t   iterations = (64 * 1024 * 1024) / len;
+    uint32_t crc = 0;
+
+    struct timespec _ts = get_timespec_now();
+    for (size_t i = 0; i < iterations; i++) {
+        data[0] = (uint8_t)crc;
+        crc = network_crc_init(type);
+        crc = network_crc_update_impl(impl, type, crc, data, len);
+        crc = network_crc_final(type, crc);
+    }
+    uint64_t time_ns = get_elapsedtime_ns(_ts);
+
+    double mb_s = (double)(iterations * len) / (time_ns / 1e9) / 1e6;
+    printf("%-6s %-8s len=%-5zu : %9.1f MB/s  %7.1f ns/call (crc=%08x)\n",
+        name, crc_names[type], len, mb_s, (double)time_ns / iterations, crc);
+}
+
+
+int main(int argc, char** argv)
+{
+    (void)argc;
+    (void)argv;
+    size_t sizes[] = { 8, 16, 64, 256, 1024, 4096 };
+
+    printf("Running Network CRC benchmark\n");
+
+    uint8_t* data = malloc(4096);
+    for (size_t i = 0; i < 4096; i++) {
+        data[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    struct {
+        const char*    name;
+        NetworkCrcImpl impl;
+    } impl[] = {
+        { "AUTO", NETWORK_CRC_IMPL_AUTO },
+        { "TABLE", NETWORK_CRC_IMPL_TABLE },
+        { "CLMUL", NETWORK_CRC_IMPL_CLMUL },
+    };
+    for (size_t i = 0; i < sizeof(impl) / sizeof(impl[0]); i++) {
+        if (network_crc_supported(impl[i].impl) == ENOTSUP) {
+            printf("%-6s not supported\n", impl[i].name);
+            continue;
+        }
+        for (NetworkCrcType t = 0; t < NETWORK_CRC__COUNT; t++) {
+            for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++) {
+                run_bench_crc(impl[i].name, impl[i].impl, t, data, sizes[j]);
+            }
+        }
+    }
+
+    free(data);
+    exit(0);
+}
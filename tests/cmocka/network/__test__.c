@@ -16,6 +16,7 @@ extern int run_parser_tests(void);
 extern int run_loader_tests(void);
 extern int run_engine_tests(void);
 extern int run_function_tests(void);
+extern int run_crc_tests(void);
 
 
 int main()
@@ -27,5 +28,6 @@ int main()
     rc |= run_loader_tests();
     rc |= run_engine_tests();
     rc |= run_function_tests();
+    rc |= run_crc_tests();
     return rc;
 }
@@ -0,0 +1,266 @@
+// Copyright 2024 Robert Bosch GmbH
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <dse/testing.h>
+#include <dse/logger.h>
+#include <dse/network/network.h>
+#include <dse/network/functions/crc.h>
+#include <dse/clib/util/yaml.h>
+
+
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+#define CRC_YAML "../../../../tests/cmocka/network/function_crc.yaml"
+
+
+typedef struct CrcFunctionTC {
+    NetworkCrcType      type;
+    NetworkFunctionFunc generate;
+    NetworkFunctionFunc validate;
+} CrcFunctionTC;
+
+static const CrcFunctionTC crc_functions[] = {
+    { NETWORK_CRC8_SAE_J1850, crc8_sae_j1850_generate,
+        crc8_sae_j1850_validate },
+    { NETWORK_CRC8H2F, crc8h2f_generate, crc8h2f_validate },
+    { NETWORK_CRC16_CCITT, crc16_ccitt_generate, crc16_ccitt_validate },
+    { NETWORK_CRC32, crc32_generate, crc32_validate },
+    { NETWORK_CRC32P4, crc32p4_generate, crc32p4_validate },
+};
+
+
+int test_crc_setup(void** state)
+{
+    YamlNode* doc = dse_yaml_load_single_doc(CRC_YAML);
+    assert_non_null(doc);
+    *state = doc;
+    return 0;
+}
+
+
+int test_crc_teardown(void** state)
+{
+    YamlNode* doc = *state;
+    if (doc) dse_yaml_destroy_node(doc);
+    return 0;
+}
+
+
+static uint32_t _crc(NetworkCrcImpl impl, NetworkCrcType type,
+    const uint8_t* data, size_t len)
+{
+    uint32_t crc = network_crc_init(type);
+    crc = network_crc_update_impl(impl, type, crc, data, len);
+    return network_crc_final(type, crc);
+}
+
+
+static NetworkFunction _function(YamlNode* doc, const char* annotations)
+{
+    char path[100];
+    snprintf(path, sizeof(path), "spec/annotations/%s", annotations);
+    YamlNode* node = dse_yaml_find_node(doc, path);
+    assert_non_null(node);
+    return (NetworkFunction){ .name = (char*)annotations, .annotations = node };
+}
+
+
+void test_crc_check_values(void** state)
+{
+    UNUSED(state);
+
+    /* Check values (AUTOSAR Crc), data "123456789". */
+    const uint8_t data[] = "123456789";
+    struct {
+        NetworkCrcType type;
+        size_t         width;
+        uint32_t       check;
+    } tc[] = {
+        { NETWORK_CRC8_SAE_J1850, 1, 0x4B },
+        { NETWORK_CRC8H2F, 1, 0xDF },
+        { NETWORK_CRC16_CCITT, 2, 0x29B1 },
+        { NETWORK_CRC32, 4, 0xCBF43926 },
+        { NETWORK_CRC32P4, 4, 0x1697D06A },
+    };
+    for (NetworkCrcImpl i = 0; i < NETWORK_CRC_IMPL__COUNT; i++) {
+        if (network_crc_supported(i) == ENOTSUP) continue;
+        for (size_t j = 0; j < ARRAY_SIZE(tc); j++) {
+            assert_int_equal(network_crc_width(tc[j].type), tc[j].width);
+            assert_int_equal(_crc(i, tc[j].type, data, 9), tc[j].check);
+        }
+    }
+    for (size_t j = 0; j < ARRAY_SIZE(tc); j++) {
+        assert_int_equal(network_crc(tc[j].type, data, 9), tc[j].check);
+    }
+}
+
+
+void test_crc_implementations(void** state)
+{
+    UNUSED(state);
+
+    uint8_t data[1024];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 31 + 7);
+    }
+    assert_int_equal(network_crc_supported(NETWORK_CRC_IMPL_TABLE), 0);
+    if (network_crc_supported(NETWORK_CRC_IMPL_CLMUL) == ENOTSUP) {
+        log_notice("CLMUL not supported, skipping test");
+        return;
+    }
+
+    /* All lengths (and alignments), the folding implementation (selected
+    when supported) matches the table implementation, also when calculated
+    incrementally. */
+    for (NetworkCrcType t = 0; t < NETWORK_CRC__COUNT; t++) {
+        for (size_t len = 0; len < 300; len++) {
+            for (size_t offset = 0; offset < 4; offset++) {
+                const uint8_t* p = data + offset;
+                uint32_t expect = _crc(NETWORK_CRC_IMPL_TABLE, t, p, len);
+                assert_int_equal(
+                    _crc(NETWORK_CRC_IMPL_CLMUL, t, p, len), expect);
+                assert_int_equal(network_crc(t, p, len), expect);
+                uint32_t crc = network_crc_init(t);
+                crc = network_crc_update(t, crc, p, len / 3);
+                crc = network_crc_update(t, crc, p + len / 3, len - len / 3);
+                assert_int_equal(network_crc_final(t, crc), expect);
+            }
+        }
+    }
+}
+
+
+void test_crc_function_generate_validate(void** state)
+{
+    YamlNode* doc = *state;
+
+    for (size_t i = 0; i < ARRAY_SIZE(crc_functions); i++) {
+        const CrcFunctionTC* tc = &crc_functions[i];
+        size_t               width = network_crc_width(tc->type);
+        const char*          position[] = { "position_0", "position_4" };
+        for (size_t j = 0; j < ARRAY_SIZE(position); j++) {
+            NetworkFunction encode = _function(doc, position[j]);
+            NetworkFunction decode = _function(doc, position[j]);
+            uint8_t         payload[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+            size_t          pos = j * 4;
+
+            /* Generate, the CRC is written and the change reported. */
+            assert_int_equal(tc->generate(&encode, payload, 16), 0);
+            assert_true(encode.modified);
+            assert_non_null(encode.data);
+            uint32_t crc = 0;
+            for (size_t k = 0; k < width; k++) {
+                crc = (crc << 8) | payload[pos + k];
+            }
+            uint32_t expect = network_crc_init(tc->type);
+            expect = network_crc_update(tc->type, expect, payload, pos);
+            expect = network_crc_update(tc->type, expect,
+                payload + pos + width, 16 - pos - width);
+            assert_int_equal(crc, network_crc_final(tc->type, expect));
+
+            /* Generate again, no change. */
+            encode.modified = false;
+            assert_int_equal(tc->generate(&encode, payload, 16), 0);
+            assert_false(encode.modified);
+
+            /* Validate, then corrupt the payload. */
+            assert_int_equal(tc->validate(&decode, payload, 16), 0);
+            payload[15] ^= 0x01;
+            assert_int_equal(tc->validate(&decode, payload, 16), EBADMSG);
+            payload[15] ^= 0x01;
+            payload[pos] ^= 0x80;
+            assert_int_equal(tc->validate(&decode, payload, 16), EBADMSG);
+
+            free(encode.data);
+            free(decode.data);
+        }
+    }
+}
+
+
+void test_crc_function_data_id(void** state)
+{
+    YamlNode* doc = *state;
+
+    for (size_t i = 0; i < ARRAY_SIZE(crc_functions); i++) {
+        const CrcFunctionTC* tc = &crc_functions[i];
+        size_t               width = network_crc_width(tc->type);
+        NetworkFunction      encode = _function(doc, "data_id");
+        NetworkFunction      decode = _function(doc, "data_id");
+        uint8_t payload[16] = { 0x10, 0x20, 0x30, 0x40, 0x50, 0x60 };
+
+        /* The Data ID (0x1234) is included, low byte first. */
+        assert_int_equal(tc->generate(&encode, payload, 16), 0);
+        const uint8_t data_id[] = { 0x34, 0x12 };
+        uint32_t      crc = 0;
+        for (size_t k = 0; k < width; k++) {
+            crc = (crc << 8) | payload[12 + k];
+        }
+        uint32_t expect = network_crc_init(tc->type);
+        expect = network_crc_update(tc->type, expect, data_id, 2);
+        expect = network_crc_update(tc->type, expect, payload, 12);
+        expect = network_crc_update(
+            tc->type, expect, payload + 12 + width, 4 - width);
+        assert_int_equal(crc, network_crc_final(tc->type, expect));
+        assert_int_equal(tc->validate(&decode, payload, 16), 0);
+
+        /* A different Data ID fails validation. */
+        NetworkFunction other = _function(doc, "data_id_other");
+        assert_int_equal(tc->generate(&other, payload, 16), 0);
+        assert_int_equal(tc->validate(&decode, payload, 16), EBADMSG);
+
+        free(encode.data);
+        free(decode.data);
+        free(other.data);
+    }
+}
+
+
+void test_crc_function_errors(void** state)
+{
+    YamlNode* doc = *state;
+    uint8_t   payload[16] = { 0 };
+
+    for (size_t i = 0; i < ARRAY_SIZE(crc_functions); i++) {
+        const CrcFunctionTC* tc = &crc_functions[i];
+
+        /* Bad arguments. */
+        NetworkFunction nf = _function(doc, "position_0");
+        assert_int_equal(tc->generate(NULL, payload, 16), EINVAL);
+        assert_int_equal(tc->validate(&nf, NULL, 16), EINVAL);
+        assert_null(nf.data);
+
+        /* Missing position annotation. */
+        nf = _function(doc, "no_position");
+        assert_int_equal(tc->generate(&nf, payload, 16), EPROTO);
+        assert_int_equal(tc->validate(&nf, payload, 16), EPROTO);
+        assert_null(nf.data);
+
+        /* CRC does not fit in the payload. */
+        nf = _function(doc, "out_of_range");
+        assert_int_equal(tc->generate(&nf, payload, 16), EINVAL);
+        assert_int_equal(tc->validate(&nf, payload, 16), EINVAL);
+        free(nf.data);
+    }
+}
+
+
+int run_crc_tests(void)
+{
+    void* s = test_crc_setup;
+    void* t = test_crc_teardown;
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_crc_check_values, s, t),
+        cmocka_unit_test_setup_teardown(test_crc_implementations, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_crc_function_generate_validate, s, t),
+        cmocka_unit_test_setup_teardown(test_crc_function_data_id, s, t),
+        cmocka_unit_test_setup_teardown(test_crc_function_errors, s, t),
+    };
+
+    return cmocka_run_group_tests_name("CRC", tests, NULL, NULL);
+}
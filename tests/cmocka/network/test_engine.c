@@ -13,7 +13,8 @@
 #include <dse/logger.h>
 
 
-#define UNUSED(x) ((void)x)
+#define UNUSED(x)     ((void)x)
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
 
 typedef struct NetworkMock {
@@ -43,15 +44,15 @@ void test_engine_network_marshal_list(void** state)
     /* Call load. */
     network_load(mock->network, mock->model_instance);
 
-    assert_string_equal(mock->network->marshal_list[0].signal->name, "enable");
+    assert_string_equal(mock->network->marshal_list[0].info->name, "enable");
     assert_string_equal(
-        mock->network->marshal_list[0].signal->signal_name, "enable");
+        mock->network->marshal_list[0].info->signal_name, "enable");
     assert_string_equal(
-        mock->network->marshal_list[1].signal->signal_name, "average_radius");
+        mock->network->marshal_list[1].info->signal_name, "average_radius");
     assert_string_equal(
-        mock->network->marshal_list[2].signal->signal_name, "temperature");
+        mock->network->marshal_list[2].info->signal_name, "temperature");
     assert_string_equal(
-        mock->network->marshal_list[3].signal->signal_name, "radius");
+        mock->network->marshal_list[3].info->signal_name, "radius");
 
     /* Check signal vector index. */
     assert_int_equal(mock->network->marshal_list[0].signal_vector_index, 0);
@@ -379,10 +380,10 @@ void test_engine_marshal_container_mux_signal(void** state)
     assert_non_null(m600);
     assert_non_null(m600->mux_signal);
     NetworkSignal* s600 = m600->mux_signal;
-    assert_string_equal(s600->name, "header_id");
     assert_non_null(s600->mux_mi);
     MarshalItem* mi600 = s600->mux_mi;
     assert_ptr_equal(mi600->signal, s600);
+    assert_string_equal(mi600->info->name, "header_id");
 
 
     network_unload(mock->network);
@@ -412,10 +413,10 @@ void test_engine_marshal_to_single_signal(void** state)
     assert_non_null(m600);
     assert_non_null(m600->mux_signal);
     NetworkSignal* s600 = m600->mux_signal;
-    assert_string_equal(s600->name, "header_id");
     assert_non_null(s600->mux_mi);
     MarshalItem* mi600 = s600->mux_mi;
     assert_ptr_equal(mi600->signal, s600);
+    assert_string_equal(mi600->info->name, "header_id");
 
     /* Test that single=true does not modify update_signals. */
     set_update_signals(n->marshal_list, false);
@@ -438,10 +439,1093 @@ void test_engine_marshal_to_single_signal(void** state)
 }
 
 
+void test_engine_marshal_signal_types(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_non_null(n->signal_vector);
+    assert_non_null(n->marshal_list);
+
+    /* Values are within the range of each signal. */
+    struct {
+        const char* name;
+        double      value;
+    } checks[] = {
+        { "u_int8_signal", 200 },
+        { "u_int16_signal", 900 },
+        { "u_int32_signal", 30000 },
+        { "u_int64_signal", 700000 },
+        { "int8_signal", -100 },
+        { "int16_signal", -2000 },
+        { "int32_signal", -200000 },
+        { "int64_signal", -800000 },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(checks); i++) {
+        int32_t idx = _find_signal_idx(n->signal_name, checks[i].name);
+        assert_in_range(idx, 0, n->signal_count);
+        n->signal_vector[idx] = checks[i].value;
+    }
+
+    /* TX Path, then clear the signals. */
+    network_marshal_signals_to_messages(n, n->marshal_list);
+    for (size_t i = 0; i < ARRAY_SIZE(checks); i++) {
+        n->signal_vector[_find_signal_idx(n->signal_name, checks[i].name)] = 0;
+    }
+
+    /* RX Path, each type is restored. */
+    set_update_signals(n->marshal_list, true);
+    network_marshal_messages_to_signals(n, n->marshal_list, false);
+    for (size_t i = 0; i < ARRAY_SIZE(checks); i++) {
+        int32_t idx = _find_signal_idx(n->signal_name, checks[i].name);
+        assert_double_equal(n->signal_vector[idx], checks[i].value, 0.0);
+    }
+
+    network_unload(mock->network);
+}
+
+
 extern int test_network_setup(void** state);
 extern int test_network_teardown(void** state);
 
 
+void test_engine_marshal_plan(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_non_null(n->signal_vector);
+    assert_non_null(n->marshal_list);
+    assert_non_null(n->marshal_plan);
+
+    /* Each marshal item is in the group of its type. */
+    size_t count = 0;
+    for (size_t t = 0; t < NETWORK_SIGNAL_TYPE__COUNT; t++) {
+        count += n->marshal_plan->group[t].count;
+    }
+    assert_int_equal(count, n->signal_count);
+    assert_non_null(n->marshal_plan->linear_encode);
+    assert_non_null(n->marshal_plan->linear_decode);
+    /* Scaled signals use the linear codec, others the library functions. */
+    MarshalGroup* g_u8 = &n->marshal_plan->group[NETWORK_SIGNAL_TYPE_UINT8];
+    assert_true(g_u8->linear_count > 0);
+    assert_true(g_u8->linear_count < g_u8->count);
+    for (size_t i = 0; i < g_u8->linear_count; i++) {
+        assert_null(g_u8->constant[i]);
+    }
+    for (MarshalItem* mi = n->marshal_list; mi && mi->signal; mi++) {
+        MarshalGroup* g = &n->marshal_plan->group[mi->signal->type];
+        uint8_t*      data =
+            (uint8_t*)mi->message->buffer + mi->signal->buffer_offset;
+        bool found = false;
+        for (size_t i = 0; i < g->count; i++) {
+            if (g->data[i] != data) continue;
+            assert_int_equal(g->index[i], mi->signal_vector_index);
+            assert_ptr_equal(g->update[i], &mi->message->update_signals);
+            found = true;
+        }
+        assert_true(found);
+    }
+
+    /* TX Path with the plan (linear codec), and then without (library
+    functions), buffers are equal. */
+    for (size_t i = 0; i < n->signal_count; i++) {
+        n->signal_vector[i] = 1;
+    }
+    network_marshal_signals_to_messages(n, n->marshal_list);
+    size_t msg_count = 0;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        msg_count++;
+    }
+    void** buffers = calloc(msg_count, sizeof(void*));
+    for (size_t i = 0; i < msg_count; i++) {
+        NetworkMessage* nm = &n->messages[i];
+        buffers[i] = calloc(1, nm->buffer_len);
+        memcpy(buffers[i], nm->buffer, nm->buffer_len);
+        memset(nm->buffer, 0, nm->buffer_len);
+    }
+    network_unload_marshal_plan(n);
+    assert_null(n->marshal_plan);
+    network_marshal_signals_to_messages(n, n->marshal_list);
+    for (size_t i = 0; i < msg_count; i++) {
+        NetworkMessage* nm = &n->messages[i];
+        assert_memory_equal(buffers[i], nm->buffer, nm->buffer_len);
+        free(buffers[i]);
+    }
+    free(buffers);
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_linear_bounds(void** state)
+{
+    UNUSED(state);
+
+    /* Raw ranges which do not include 0 (minimum > 0, maximum < 0), and
+    one which does. */
+    struct {
+        NetworkSignal signal;
+        int64_t       raw_min;
+        int64_t       raw_max;
+    } tc[] = {
+        { { .type = NETWORK_SIGNAL_TYPE_UINT8, .factor = 1.0, .minimum = 10,
+              .maximum = 200 },
+            10, 200 },
+        { { .type = NETWORK_SIGNAL_TYPE_INT16, .factor = 1.0, .minimum = -300,
+              .maximum = -5 },
+            -300, -5 },
+        { { .type = NETWORK_SIGNAL_TYPE_INT8, .factor = 0.5, .offset = 10,
+              .minimum = 15, .maximum = 50 },
+            10, 80 },
+        { { .type = NETWORK_SIGNAL_TYPE_INT32, .factor = 0.1, .minimum = -20,
+              .maximum = 20 },
+            -200, 200 },
+    };
+    /* Raw values around each bound. */
+    double delta[] = { -1.0, -0.99, -0.5, -0.01, 0.0, 0.01, 0.5, 0.99, 1.0 };
+
+    NetworkLinearCodec encode = network_linear_encoder();
+    NetworkLinearCodec decode = network_linear_decoder();
+    for (size_t i = 0; i < ARRAY_SIZE(tc); i++) {
+        NetworkSignal* ns = &tc[i].signal;
+        double         lower, upper;
+        network_linear_bounds(ns, &lower, &upper);
+        int64_t bound[] = { tc[i].raw_min, tc[i].raw_max };
+        for (size_t b = 0; b < ARRAY_SIZE(bound); b++) {
+            for (size_t d = 0; d < ARRAY_SIZE(delta); d++) {
+                /* Encode, valid as the library (truncate then range). */
+                double raw = (double)bound[b] + delta[d];
+                double value = raw * ns->factor + ns->offset;
+                double valid = 0.0;
+                encode(1, &value, &ns->factor, &ns->offset, &lower, &upper,
+                    &valid);
+                int64_t truncated = (int64_t)value;
+                bool    expect =
+                    (truncated >= tc[i].raw_min && truncated <= tc[i].raw_max);
+                assert_int_equal(valid != 0.0, expect);
+            }
+            /* Decode, integer raw values. */
+            for (int64_t r = bound[b] - 2; r <= bound[b] + 2; r++) {
+                double value = (double)r;
+                double valid = 1.0;
+                decode(1, &value, &ns->factor, &ns->offset, &lower, &upper,
+                    &valid);
+                assert_int_equal(
+                    valid != 0.0, (r >= tc[i].raw_min && r <= tc[i].raw_max));
+            }
+        }
+    }
+}
+
+
+void test_engine_marshal_changed_signals(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_non_null(n->marshal_plan);
+    NetworkMessage* message1 = &n->messages[0];
+    NetworkMessage* message2 = &n->messages[1];
+    assert_string_equal(message1->name, "example_message");
+    assert_string_equal(message2->name, "example_message2");
+
+    /* Initial marshal and pack (as done by model_create). */
+    network_marshal_signals_to_messages(n, n->marshal_list);
+    network_pack_messages(n);
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        nm->needs_tx = false;
+    }
+
+    /* Change signals on both messages, only mark one. */
+    int32_t radius_idx = _find_signal_idx(n->signal_name, "radius");
+    int32_t enable_idx = _find_signal_idx(n->signal_name, "enable");
+    assert_in_range(radius_idx, 0, n->signal_count);
+    assert_in_range(enable_idx, 0, n->signal_count);
+    n->signal_vector[radius_idx] = 2;
+    n->signal_vector[enable_idx] = 1;
+    network_signal_changed(n, radius_idx);
+    network_marshal_changed_signals(n);
+    assert_true(message2->needs_pack);
+    assert_false(message1->needs_pack);
+    assert_int_equal(((uint8_t*)message2->buffer)[0], 20);
+    assert_int_equal(((uint8_t*)message1->buffer)[0], 0);
+
+    /* Only the changed message is packed (and will TX). */
+    network_pack_changed_messages(n);
+    assert_false(message2->needs_pack);
+    assert_true(message2->needs_tx);
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        if (nm == message2) continue;
+        assert_false(nm->needs_tx);
+    }
+
+    /* Mark by message, all message signals are marshalled. */
+    n->signal_vector[radius_idx] = 3;
+    network_message_changed(n, message1);
+    network_marshal_changed_signals(n);
+    assert_true(message1->needs_pack);
+    assert_false(message2->needs_pack);
+    assert_int_equal(((uint8_t*)message1->buffer)[0], 1);
+    assert_int_equal(((uint8_t*)message2->buffer)[0], 20);
+
+    /* Bitmap is cleared. */
+    message1->needs_pack = false;
+    network_marshal_changed_signals(n);
+    assert_false(message1->needs_pack);
+
+    network_unload(mock->network);
+}
+
+
+static size_t __library_calls;
+
+static int8_t _encode_stub(double value)
+{
+    UNUSED(value);
+    __library_calls++;
+    return 99;
+}
+
+static bool _range_stub(int8_t value)
+{
+    UNUSED(value);
+    __library_calls++;
+    return true;
+}
+
+static double _decode_stub(int8_t value)
+{
+    UNUSED(value);
+    __library_calls++;
+    return 99;
+}
+
+
+static void _stub_library_funcs(Network* n, MarshalItem* mi)
+{
+    MarshalGroup* g = &n->marshal_plan->group[mi->signal->type];
+    g->encode_func[mi->plan_index] = _encode_stub;
+    g->decode_func[mi->plan_index] = _decode_stub;
+    g->range_func[mi->plan_index] = _range_stub;
+    network_signal_set_funcs(
+        mi->signal, _encode_stub, _decode_stub, _range_stub);
+    __library_calls = 0;
+}
+
+
+void test_engine_marshal_changed_linear(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_non_null(n->marshal_plan);
+    NetworkMessage* message2 = &n->messages[1];
+    assert_string_equal(message2->name, "example_message2");
+    int32_t radius_idx = _find_signal_idx(n->signal_name, "radius");
+    assert_in_range(radius_idx, 0, n->signal_count);
+    MarshalItem* mi = n->marshal_plan->signal_item[radius_idx];
+    assert_non_null(mi);
+    assert_true(mi->signal->linear);
+    MarshalGroup* g = &n->marshal_plan->group[mi->signal->type];
+    assert_true(mi->plan_index < g->linear_count);
+
+    /* Without fused functions, library functions are stubbed. */
+    message2->marshal_index = NULL;
+    _stub_library_funcs(n, mi);
+
+    /* TX Path (step), the linear codec encodes the changed signal. */
+    n->signal_vector[radius_idx] = 2;
+    network_signal_changed(n, radius_idx);
+    network_marshal_changed_signals(n);
+    assert_true(message2->needs_pack);
+    assert_int_equal(((uint8_t*)message2->buffer)[0], 20);
+    assert_int_equal(__library_calls, 0);
+
+    /* Out of range, the buffer is not changed. */
+    n->signal_vector[radius_idx] = 6;
+    network_signal_changed(n, radius_idx);
+    network_marshal_changed_signals(n);
+    assert_int_equal(((uint8_t*)message2->buffer)[0], 20);
+    assert_int_equal(__library_calls, 0);
+
+    /* Single item list (not the full list). */
+    n->signal_vector[radius_idx] = 4;
+    MarshalItem list[] = { *mi, { .signal = NULL } };
+    network_marshal_signals_to_messages(n, list);
+    assert_int_equal(((uint8_t*)message2->buffer)[0], 40);
+    assert_int_equal(__library_calls, 0);
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_marshal_updated_messages(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_non_null(n->update_list);
+    NetworkMessage* message1 = &n->messages[0];
+    NetworkMessage* message2 = &n->messages[1];
+    assert_string_equal(message1->name, "example_message");
+    assert_string_equal(message2->name, "example_message2");
+
+    /* Each message owns a contiguous slice of the marshal list. */
+    size_t count = 0;
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        for (size_t i = 0; i < nm->marshal_count; i++) {
+            assert_ptr_equal(nm->marshal_items[i].message, nm);
+            assert_int_equal(nm->marshal_items[i].signal_vector_index,
+                nm->marshal_items - n->marshal_list + i);
+        }
+        count += nm->marshal_count;
+    }
+    assert_int_equal(count, n->signal_count);
+
+    /* Queue a message (only once). */
+    int32_t radius_idx = _find_signal_idx(n->signal_name, "radius");
+    int32_t enable_idx = _find_signal_idx(n->signal_name, "enable");
+    assert_in_range(radius_idx, 0, n->signal_count);
+    assert_in_range(enable_idx, 0, n->signal_count);
+    ((uint8_t*)message2->buffer)[0] = 30;
+    ((uint8_t*)message1->buffer)[0] = 1;
+    network_message_update(n, message2);
+    network_message_update(n, message2);
+    assert_int_equal(n->update_count, 1);
+    assert_true(message2->update_signals);
+
+    /* Only the queued message is decoded. */
+    network_marshal_updated_messages(n);
+    assert_double_equal(n->signal_vector[radius_idx], 3.0, 0.0);
+    assert_double_equal(n->signal_vector[enable_idx], 0.0, 0.0);
+    assert_int_equal(n->update_count, 0);
+    assert_false(message2->update_signals);
+    assert_false(message2->update_queued);
+
+    /* Queued messages which were reset (i.e. filtered) are not decoded. */
+    ((uint8_t*)message2->buffer)[0] = 40;
+    network_message_update(n, message2);
+    message2->update_signals = false;
+    network_marshal_updated_messages(n);
+    assert_double_equal(n->signal_vector[radius_idx], 3.0, 0.0);
+    assert_int_equal(n->update_count, 0);
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_marshal_updated_linear(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_non_null(n->marshal_plan);
+    NetworkMessage* message1 = &n->messages[0];
+    NetworkMessage* message2 = &n->messages[1];
+    assert_string_equal(message2->name, "example_message2");
+    int32_t radius_idx = _find_signal_idx(n->signal_name, "radius");
+    assert_in_range(radius_idx, 0, n->signal_count);
+    MarshalItem* mi = n->marshal_plan->signal_item[radius_idx];
+    assert_non_null(mi);
+    assert_true(mi->signal->linear);
+
+    /* Each message has slices of the plan groups, covering its items. */
+    assert_int_equal(message2->marshal_slice_count, 1);
+    assert_int_equal(message2->marshal_slices[0].type, mi->signal->type);
+    assert_int_equal(message2->marshal_slices[0].begin, mi->plan_index);
+    assert_int_equal(message2->marshal_slices[0].end, mi->plan_index + 1);
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        size_t count = 0;
+        for (size_t i = 0; i < nm->marshal_slice_count; i++) {
+            count += nm->marshal_slices[i].end - nm->marshal_slices[i].begin;
+        }
+        assert_int_equal(count, nm->marshal_count);
+    }
+    /* Slices are merged (enable, average_radius and temperature). */
+    assert_int_equal(message1->marshal_slice_count, 2);
+
+    /* Without fused functions, library functions are stubbed. */
+    message2->marshal_index = NULL;
+    _stub_library_funcs(n, mi);
+
+    /* RX Path (step), the linear codec decodes the received message. */
+    ((uint8_t*)message2->buffer)[0] = 30;
+    network_message_update(n, message2);
+    network_marshal_updated_messages(n);
+    assert_double_equal(n->signal_vector[radius_idx], 3.0, 0.0);
+    assert_int_equal(__library_calls, 0);
+
+    /* Out of range, the signal is not changed. */
+    ((uint8_t*)message2->buffer)[0] = 60;
+    network_message_update(n, message2);
+    network_marshal_updated_messages(n);
+    assert_double_equal(n->signal_vector[radius_idx], 3.0, 0.0);
+    assert_int_equal(__library_calls, 0);
+
+    /* Single item (i.e. a mux signal). */
+    ((uint8_t*)message2->buffer)[0] = 40;
+    network_marshal_messages_to_signals(n, mi, true);
+    assert_double_equal(n->signal_vector[radius_idx], 4.0, 0.0);
+    assert_int_equal(__library_calls, 0);
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_find_message(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_non_null(n->frame_index);
+    int32_t mux_msg_idx = _find_message_idx(n, "mux_message");
+    int32_t scheduled_idx = _find_message_idx(n, "scheduled_message");
+    assert_in_range(mux_msg_idx, 0, 100);
+    assert_in_range(scheduled_idx, 0, 100);
+
+    /* Lookup by frame_id and frame_type. */
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        if (nm->container) continue;
+        assert_ptr_equal(
+            network_find_message(n, nm->frame_id, nm->frame_type), nm);
+    }
+    /* Container (not the contained messages, which share the frame_id). */
+    assert_ptr_equal(
+        network_find_message(n, 600, 1), &n->messages[mux_msg_idx]);
+    /* Frame received with a different frame_type. */
+    assert_ptr_equal(
+        network_find_message(n, 0x1f6, 0), &n->messages[scheduled_idx]);
+    /* Unknown frame. */
+    assert_null(network_find_message(n, 0x7ff, 0));
+
+    /* Frame ID 0 is a valid frame. */
+    n->messages[scheduled_idx].frame_id = 0;
+    network_unload_marshal_lists(n);
+    network_load_marshal_lists(n);
+    assert_ptr_equal(
+        network_find_message(n, 0, 2), &n->messages[scheduled_idx]);
+    assert_null(network_find_message(n, 0x1f6, 2));
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_find_mux_message(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    int32_t mux_msg_idx = _find_message_idx(n, "mux_message");
+    int32_t mux_601_idx = _find_message_idx(n, "mux_message_601");
+    int32_t mux_602_idx = _find_message_idx(n, "mux_message_602");
+    assert_in_range(mux_msg_idx, 0, 100);
+    assert_in_range(mux_601_idx, 0, 100);
+    assert_in_range(mux_602_idx, 0, 100);
+    NetworkMessage* container = &n->messages[mux_msg_idx];
+
+    /* Only container messages have an index. */
+    assert_non_null(container->mux_index);
+    assert_true(container->mux_index_size >= 4);
+    assert_null(n->messages[mux_601_idx].mux_index);
+
+    /* Lookup by mux_id. */
+    assert_ptr_equal(network_find_mux_message(n, container, 601),
+        &n->messages[mux_601_idx]);
+    assert_ptr_equal(network_find_mux_message(n, container, 602),
+        &n->messages[mux_602_idx]);
+    assert_null(network_find_mux_message(n, container, 603));
+    assert_null(network_find_mux_message(n, container, 0));
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_buffer_change_detection(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    int32_t msg_idx = _find_message_idx(n, "unsigned_types");
+    assert_in_range(msg_idx, 0, 100);
+    NetworkMessage* nm = &n->messages[msg_idx];
+    assert_non_null(nm->buffer_shadow);
+    assert_true(nm->buffer_len > 8);
+
+    /* Initial pack, the shadow buffer is not valid. */
+    assert_true(network_message_buffer_changed(nm));
+    network_marshal_signals_to_messages(n, n->marshal_list);
+    network_pack_messages(n);
+    assert_true(nm->needs_tx);
+    assert_true(nm->buffer_shadow_valid);
+    assert_false(network_message_buffer_changed(nm));
+    network_pack_messages(n);
+    assert_false(nm->needs_tx);
+
+    /* Changes to any byte are detected (i.e. in the tail word). */
+    uint8_t* buffer = nm->buffer;
+    buffer[nm->buffer_len - 1] ^= 0x01;
+    assert_true(network_message_buffer_changed(nm));
+    network_message_buffer_commit(nm);
+    assert_false(network_message_buffer_changed(nm));
+    buffer[0] ^= 0x80;
+    assert_true(network_message_buffer_changed(nm));
+    buffer[0] ^= 0x80;
+    assert_false(network_message_buffer_changed(nm));
+
+    /* Invalid shadow buffer (i.e. schedule alarm). */
+    nm->buffer_shadow_valid = false;
+    assert_true(network_message_buffer_changed(nm));
+
+    /* Wide hash. */
+    uint8_t  data[11] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    uint64_t h = network_hash64(data, sizeof(data));
+    assert_int_equal(h, network_hash64(data, sizeof(data)));
+    data[10] = 0;
+    assert_int_not_equal(h, network_hash64(data, sizeof(data)));
+    assert_int_not_equal(
+        network_hash64(data, 8), network_hash64(data, sizeof(data)));
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_marshal_fused(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    NetworkMessage* message1 = &n->messages[0];
+    NetworkMessage* message2 = &n->messages[1];
+    assert_string_equal(message1->name, "example_message");
+    assert_string_equal(message2->name, "example_message2");
+
+    /* Fused functions are resolved, except for container messages. */
+    assert_non_null(message1->marshal_index);
+    assert_non_null(message2->marshal_index);
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        if (nm->mux_signal) assert_null(nm->marshal_index);
+        if (nm->marshal_index == NULL) continue;
+        size_t first = nm->marshal_items - n->marshal_list;
+        for (size_t i = 0; i < nm->marshal_count; i++) {
+            assert_in_range(
+                nm->marshal_index[i], first, first + nm->marshal_count - 1);
+        }
+    }
+
+    /* TX: marshal and encode the message in one call. */
+    int32_t radius_idx = _find_signal_idx(n->signal_name, "radius");
+    int32_t enable_idx = _find_signal_idx(n->signal_name, "enable");
+    assert_in_range(radius_idx, 0, n->signal_count);
+    assert_in_range(enable_idx, 0, n->signal_count);
+    n->signal_vector[radius_idx] = 2;
+    n->signal_vector[enable_idx] = 1;
+    network_message_changed(n, message1);
+    network_message_changed(n, message2);
+    network_marshal_changed_signals(n);
+    assert_true(message1->needs_pack);
+    assert_true(message2->needs_pack);
+    assert_int_equal(((uint8_t*)message1->buffer)[0], 1);
+    assert_int_equal(((uint8_t*)message2->buffer)[0], 20);
+
+    /* RX: decode the message in one call. */
+    ((uint8_t*)message2->buffer)[0] = 30;
+    network_message_update(n, message2);
+    network_marshal_updated_messages(n);
+    assert_double_equal(n->signal_vector[radius_idx], 3.0, 0.0);
+    assert_double_equal(n->signal_vector[enable_idx], 1.0, 0.0);
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_schedule_tick(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    NetworkMessage* message1 = &n->messages[0];
+    NetworkMessage* message2 = &n->messages[1];
+    int32_t scheduled_idx = _find_message_idx(n, "scheduled_message");
+    assert_in_range(scheduled_idx, 0, 100);
+    NetworkMessage* scheduled = &n->messages[scheduled_idx];
+    assert_int_equal(scheduled->cycle_time_us, 10000);
+    message1->cycle_time_us = 3000;
+    message2->cycle_time_us = 4000;
+    network_schedule_reset(n);
+    assert_int_equal(n->schedule_count, 3);
+
+    /* Alarms fire on each multiple of the cycle time (not at tick 0). */
+    NetworkMessage* check[] = { message1, message2, scheduled };
+    for (uint32_t tick = 0; tick <= 60; tick++) {
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            nm->needs_tx = false;
+            nm->buffer_shadow_valid = true;
+        }
+        assert_int_equal(n->tick, tick);
+        network_schedule_tick(n);
+        for (size_t i = 0; i < ARRAY_SIZE(check); i++) {
+            uint32_t cycle = check[i]->cycle_time_us / 1000;
+            bool     due = tick && (tick % cycle == 0);
+            assert_int_equal(check[i]->needs_tx, due);
+            assert_int_equal(check[i]->buffer_shadow_valid, !due);
+        }
+    }
+
+    /* Messages without a cycle time are removed from the schedule. */
+    message1->cycle_time_us = 0;
+    for (uint32_t t = 0; t < 4; t++) {
+        message1->needs_tx = false;
+        network_schedule_tick(n);
+        assert_false(message1->needs_tx);
+    }
+    assert_int_equal(n->schedule_count, 2);
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_schedule_advance(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    NetworkMessage* message1 = &n->messages[0];
+    NetworkMessage* message2 = &n->messages[1];
+    int32_t scheduled_idx = _find_message_idx(n, "scheduled_message");
+    assert_in_range(scheduled_idx, 0, 100);
+    NetworkMessage* scheduled = &n->messages[scheduled_idx];
+    message1->cycle_time_us = 3000;
+    message2->cycle_time_us = 4000;
+    network_schedule_reset(n);
+
+    /* Advance over several ticks, alarms fire once (ticks 0..N-1). */
+    struct {
+        uint64_t ticks;
+        bool     tx[3];
+    } checks[] = {
+        { 0, { false, false, false } },   /* No ticks. */
+        { 1, { false, false, false } },   /* Tick 0. */
+        { 6, { true, true, false } },     /* Ticks 1..6. */
+        { 3, { true, true, false } },     /* Ticks 7..9. */
+        { 1, { false, false, true } },    /* Tick 10. */
+        { 1, { false, false, false } },   /* Tick 11. */
+        { 1, { true, true, false } },     /* Tick 12. */
+        { 1000, { true, true, true } },   /* Ticks 13..1012. */
+        { 1, { false, false, false } },   /* Tick 1013. */
+    };
+    NetworkMessage* tx[] = { message1, message2, scheduled };
+    uint64_t        tick = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(checks); i++) {
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            nm->needs_tx = false;
+        }
+        network_schedule_advance(n, checks[i].ticks);
+        tick += checks[i].ticks;
+        assert_int_equal(n->tick, tick);
+        for (size_t j = 0; j < ARRAY_SIZE(tx); j++) {
+            assert_int_equal(tx[j]->needs_tx, checks[i].tx[j]);
+        }
+    }
+
+    /* Alarms are re-armed on the cycle (next alarms at tick 1014/1016). */
+    network_schedule_tick(n);
+    assert_true(message1->needs_tx);
+    assert_false(message2->needs_tx);
+    network_schedule_advance(n, 2);
+    assert_true(message2->needs_tx);
+    assert_false(scheduled->needs_tx);
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_schedule_resolution(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_int_equal(n->schedule_resolution_us, 1000);
+    NetworkMessage* message1 = &n->messages[0];
+    NetworkMessage* message2 = &n->messages[1];
+    int32_t scheduled_idx = _find_message_idx(n, "scheduled_message");
+    assert_in_range(scheduled_idx, 0, 100);
+    NetworkMessage* scheduled = &n->messages[scheduled_idx];
+
+    /* 250 us tick, cycle times are converted to ticks. */
+    n->schedule_resolution_us = 250;
+    message1->cycle_time_us = 250;
+    message2->cycle_time_us = 500;
+    network_schedule_reset(n);
+    assert_int_equal(n->schedule_count, 3);
+    NetworkMessage* check[] = { message1, message2, scheduled };
+    for (uint32_t tick = 0; tick <= 100; tick++) {
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            nm->needs_tx = false;
+        }
+        network_schedule_tick(n);
+        for (size_t i = 0; i < ARRAY_SIZE(check); i++) {
+            uint32_t cycle = check[i]->cycle_time_us / 250;
+            assert_int_equal(check[i]->needs_tx, tick && (tick % cycle == 0));
+        }
+    }
+
+    /* Cycle times are rounded to the resolution (at least one tick). */
+    n->schedule_resolution_us = 1000;
+    message1->cycle_time_us = 250;
+    message2->cycle_time_us = 2400;
+    network_schedule_reset(n);
+    assert_int_equal(n->schedule_list[0].cycle, 1);
+    assert_int_equal(n->schedule_list[1].cycle, 2);
+    assert_int_equal(n->schedule_list[2].cycle, 10);
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_schedule_offset(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    assert_false(n->schedule_phase_spread);
+    NetworkMessage* message1 = &n->messages[0];
+    NetworkMessage* message2 = &n->messages[1];
+    int32_t scheduled_idx = _find_message_idx(n, "scheduled_message");
+    assert_in_range(scheduled_idx, 0, 100);
+    NetworkMessage* scheduled = &n->messages[scheduled_idx];
+    assert_int_equal(scheduled->cycle_offset_us, 0);
+
+    /* Offsets set the phase of the cycle (first alarm at the offset). */
+    message1->cycle_time_us = 3000;
+    message1->cycle_offset_us = 1000;
+    message2->cycle_time_us = 4000;
+    message2->cycle_offset_us = 6000; /* Initial delay. */
+    network_schedule_reset(n);
+    struct {
+        NetworkMessage* nm;
+        uint32_t        cycle;
+        uint32_t        first;
+    } checks[] = {
+        { message1, 3, 1 },
+        { message2, 4, 6 },
+        { scheduled, 10, 10 },
+    };
+    for (uint32_t tick = 0; tick <= 60; tick++) {
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            nm->needs_tx = false;
+        }
+        network_schedule_tick(n);
+        for (size_t i = 0; i < ARRAY_SIZE(checks); i++) {
+            bool due = (tick >= checks[i].first) &&
+                       ((tick - checks[i].first) % checks[i].cycle == 0);
+            assert_int_equal(checks[i].nm->needs_tx, due);
+        }
+    }
+
+    /* Phase spread, messages without an offset fire on different ticks. */
+    message1->cycle_time_us = 10000;
+    message1->cycle_offset_us = 0;
+    message2->cycle_time_us = 10000;
+    message2->cycle_offset_us = 0;
+    n->schedule_phase_spread = true;
+    network_schedule_reset(n);
+    for (uint32_t tick = 0; tick <= 60; tick++) {
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            nm->needs_tx = false;
+        }
+        network_schedule_tick(n);
+        uint32_t fired = 0;
+        for (size_t i = 0; i < ARRAY_SIZE(checks); i++) {
+            if (checks[i].nm->needs_tx) fired++;
+        }
+        assert_true(fired <= 1);
+        if (tick % 10 == 0 && tick) assert_true(message1->needs_tx);
+        if (tick % 10 == 1) assert_true(message2->needs_tx);
+        if (tick % 10 == 2) assert_true(scheduled->needs_tx);
+    }
+
+    network_unload(mock->network);
+}
+
+
+static void _tx_mode_step(Network* n, uint64_t tick, double* value,
+    double change, bool* tx)
+{
+    /* Emulate a model step (at tick), with an optional signal change. */
+    if (change != *value) {
+        *value = change;
+        for (size_t i = 0; i < n->signal_count; i++) {
+            if (&n->signal_vector[i] == value) network_signal_changed(n, i);
+        }
+    }
+    network_schedule_advance(n, tick + 1 - n->tick);
+    network_marshal_changed_signals(n);
+    network_pack_changed_messages(n);
+    for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+        if (nm->needs_tx) tx[nm - n->messages] = true;
+        nm->needs_tx = false; /* network_encode_to_bus() */
+    }
+}
+
+
+void test_engine_schedule_tx_mode(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    NetworkMessage* message2 = &n->messages[1];
+    assert_string_equal(message2->name, "example_message2");
+    int32_t radius_idx = _find_signal_idx(n->signal_name, "radius");
+    assert_in_range(radius_idx, 0, n->signal_count);
+    double* radius = &n->signal_vector[radius_idx];
+    assert_int_equal(message2->tx_mode, NETWORK_TX_MODE_DEFAULT);
+    assert_int_equal(network_tx_mode(message2), NETWORK_TX_MODE_DIRECT);
+
+    struct {
+        const char*   name;
+        NetworkTxMode mode;
+        uint32_t      cycle_us;
+        uint32_t      mdt_us;
+        uint32_t      repetitions;
+        uint32_t      repetition_us;
+        double        change[30]; /* Radius at each tick (step). */
+        bool          tx[30];
+    } checks[] = {
+        {
+            .name = "direct with repetitions",
+            .mode = NETWORK_TX_MODE_DIRECT,
+            .repetitions = 2,
+            .repetition_us = 2000,
+            .change = { [5 ... 29] = 1 },
+            .tx = { [5] = true, [7] = true, [9] = true },
+        },
+        {
+            .name = "direct with MDT",
+            .mode = NETWORK_TX_MODE_DIRECT,
+            .mdt_us = 10000,
+            .change = { [5 ... 7] = 1, [8 ... 11] = 2, [12 ... 29] = 3 },
+            .tx = { [5] = true, [15] = true },
+        },
+        {
+            .name = "mixed with repetitions",
+            .mode = NETWORK_TX_MODE_MIXED,
+            .cycle_us = 10000,
+            .repetitions = 1,
+            .repetition_us = 3000,
+            .change = { [13 ... 29] = 1 },
+            .tx = { [10] = true, [13] = true, [16] = true, [20] = true },
+        },
+        {
+            .name = "mixed with MDT",
+            .mode = NETWORK_TX_MODE_MIXED,
+            .cycle_us = 10000,
+            .mdt_us = 5000,
+            .change = { [12 ... 29] = 1 },
+            .tx = { [10] = true, [15] = true, [20] = true },
+        },
+        {
+            .name = "periodic (changes do not TX)",
+            .mode = NETWORK_TX_MODE_PERIODIC,
+            .cycle_us = 10000,
+            .change = { [12 ... 29] = 1 },
+            .tx = { [10] = true, [20] = true },
+        },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(checks); i++) {
+        log_info("TX mode: %s", checks[i].name);
+        message2->tx_mode = checks[i].mode;
+        message2->cycle_time_us = checks[i].cycle_us;
+        message2->tx_min_delay_us = checks[i].mdt_us;
+        message2->tx_repetitions = checks[i].repetitions;
+        message2->tx_repetition_us = checks[i].repetition_us;
+
+        /* Initial conditions (as done by model_create). */
+        *radius = 0;
+        network_marshal_signals_to_messages(n, n->marshal_list);
+        network_pack_messages(n);
+        for (NetworkMessage* nm = n->messages; nm && nm->name; nm++) {
+            nm->needs_tx = false;
+        }
+        network_schedule_reset(n);
+        for (uint64_t tick = 0; tick < 30; tick++) {
+            bool tx[100] = {};
+            _tx_mode_step(n, tick, radius, checks[i].change[tick], tx);
+            assert_int_equal(tx[1], checks[i].tx[tick]);
+        }
+    }
+
+    network_unload(mock->network);
+}
+
+
+void test_engine_schedule_rx_timeout(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+
+    /* Call load. */
+    network_load(mock->network, mock->model_instance);
+    assert_non_null(n);
+    NetworkMessage* message1 = &n->messages[0];
+    assert_string_equal(message1->name, "example_message");
+    int32_t average_radius_idx =
+        _find_signal_idx(n->signal_name, "average_radius");
+    assert_in_range(average_radius_idx, 0, n->signal_count);
+    double* average_radius = &n->signal_vector[average_radius_idx];
+    double  status = 0.0;
+    message1->rx_timeout_us = 20000;
+    message1->rx_timeout_substitute = true;
+    message1->rx_timeout_value = &status;
+    network_schedule_reset(n);
+    assert_int_equal(n->schedule_count, 2);
+
+    /* RX (frames) at ticks 5 and 20, deadlines at 25 and 40. */
+    for (uint64_t tick = 0; tick < 60; tick++) {
+        if (tick == 5 || tick == 20) {
+            network_schedule_rx(n, message1);
+            *average_radius = 4.0;
+            ((uint8_t*)message1->buffer)[1] = 40;
+            message1->buffer_shadow_valid = true;
+        }
+        network_schedule_tick(n);
+        bool timed_out = (tick >= 40);
+        assert_int_equal(message1->rx_timed_out, timed_out);
+        assert_double_equal(status, timed_out ? 1.0 : 0.0, 0.0);
+        if (timed_out) {
+            /* Init values are substituted, marshalled and committed. */
+            assert_double_equal(*average_radius, 1.0, 0.0);
+            assert_int_equal(((uint8_t*)message1->buffer)[1], 10);
+            assert_true(message1->buffer_shadow_valid);
+        } else {
+            assert_double_equal(*average_radius, tick < 5 ? 0.0 : 4.0, 0.0);
+        }
+    }
+
+    /* TX, the message is received (not sent) so no TX is raised. */
+    message1->needs_tx = false;
+    network_marshal_changed_signals(n);
+    network_pack_changed_messages(n);
+    assert_false(message1->needs_tx);
+    assert_int_equal(((uint8_t*)message1->buffer)[1], 10);
+
+    /* The next RX (same frame as before the timeout) is decoded. */
+    ((uint8_t*)message1->buffer)[1] = 40;
+    assert_true(network_message_buffer_changed(message1));
+
+    /* RX clears the timeout (and rearms the deadline). */
+    network_schedule_rx(n, message1);
+    assert_false(message1->rx_timed_out);
+    assert_double_equal(status, 0.0, 0.0);
+    network_schedule_advance(n, 20);
+    assert_false(message1->rx_timed_out);
+    network_schedule_tick(n);
+    assert_true(message1->rx_timed_out);
+
+    /* The timeout is only detected from tick 0 (first deadline). */
+    network_schedule_reset(n);
+    network_schedule_advance(n, 20);
+    assert_false(message1->rx_timed_out);
+    network_schedule_tick(n);
+    assert_true(message1->rx_timed_out);
+
+    network_unload(mock->network);
+}
+
+
 int run_engine_tests(void)
 {
     void* s = test_network_setup;
@@ -465,6 +1549,31 @@ int run_engine_tests(void)
             test_engine_marshal_container_mux_signal, s, t),
         cmocka_unit_test_setup_teardown(
             test_engine_marshal_to_single_signal, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_engine_marshal_signal_types, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_marshal_plan, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_linear_bounds, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_engine_marshal_changed_signals, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_engine_marshal_changed_linear, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_engine_marshal_updated_messages, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_engine_marshal_updated_linear, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_find_message, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_find_mux_message, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_engine_buffer_change_detection, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_marshal_fused, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_schedule_tick, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_schedule_advance, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_engine_schedule_resolution, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_schedule_offset, s, t),
+        cmocka_unit_test_setup_teardown(test_engine_schedule_tx_mode, s, t),
+        cmocka_unit_test_setup_teardown(
+            test_engine_schedule_rx_timeout, s, t),
     };
 
     return cmocka_run_group_tests_name("ENGINE", tests, NULL, NULL);
@@ -63,6 +63,12 @@ void test_function_encode(void** state)
     assert_double_equal(network->signal_vector[6], 5.0, 0.0);
     assert_double_equal(network->signal_vector[7], 50.0, 0.0);
 
+    /* Check the functions reported the modification. */
+    assert_true(nm_p->encode_functions[0].reports_modified);
+    assert_true(nm_p->encode_functions[0].modified);
+    assert_true(nm_p->encode_functions[1].reports_modified);
+    assert_true(nm_p->encode_functions[1].modified);
+
     /* Check the allocated data. */
     assert_non_null(nm_p->encode_functions[0].data);
     assert_non_null(nm_p->encode_functions[1].data);
@@ -76,6 +82,11 @@ void test_function_encode(void** state)
     assert_ptr_equal(nm_p->encode_functions[0].data, idm0);
     assert_ptr_equal(nm_p->encode_functions[1].data, idm1);
 
+    /* The modification is reported (the payload is not compared). */
+    assert_int_equal(((uint8_t*)payload)[(1) / sizeof(uint8_t)], 3);
+    assert_true(nm_p->encode_functions[0].modified);
+    assert_true(nm_p->update_signals);
+
     network_unload(mock->network);
 }
 
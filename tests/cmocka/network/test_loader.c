@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <dlfcn.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/network/network.h>
@@ -65,53 +66,71 @@ void test_network_load_message_funcs(void** state)
 void test_network_load_signal_funcs(void** state)
 {
     UNUSED(state);
-    Network       network = { .name = "stub" };
-    NetworkSignal network_message1_signals[] = {
+    Network           network = { .name = "stub" };
+    NetworkSignalInfo network_message1_info[] = {
         { .name = "enable", .member_type = "uint8_t" },
         { .name = "average_radius", .member_type = "uint8_t" },
         { .name = "temperature", .member_type = "int16_t" },
         { .name = NULL },
     };
-    NetworkSignal network_message2_signals[] = {
+    NetworkSignal     network_message1_signals[4] = {};
+    NetworkSignalInfo network_message2_info[] = {
         { .name = "radius", .member_type = "uint8_t" },
         { .name = NULL },
     };
-    NetworkSignal network_function_signals[] = {
+    NetworkSignal     network_message2_signals[2] = {};
+    NetworkSignalInfo network_function_info[] = {
         { .name = "crc", .member_type = "uint8_t" },
         { .name = "alive", .member_type = "uint8_t" },
         { .name = "foo", .member_type = "uint8_t" },
         { .name = "bar", .member_type = "uint8_t" },
         { .name = NULL },
     };
-    NetworkSignal network_unsigned_signals[] = {
+    NetworkSignal     network_function_signals[5] = {};
+    NetworkSignalInfo network_unsigned_info[] = {
         { .name = "u_int8_signal", .member_type = "uint8_t" },
         { .name = "u_int16_signal", .member_type = "uint16_t" },
         { .name = "u_int32_signal", .member_type = "uint32_t" },
         { .name = "u_int64_signal", .member_type = "uint64_t" },
         { .name = NULL },
     };
-    NetworkSignal network_signed_signals[] = {
+    NetworkSignal     network_unsigned_signals[5] = {};
+    NetworkSignalInfo network_signed_info[] = {
         { .name = "int8_signal", .member_type = "int8_t" },
         { .name = "int16_signal", .member_type = "int16_t" },
         { .name = "int32_signal", .member_type = "int32_t" },
         { .name = "int64_signal", .member_type = "int64_t" },
         { .name = NULL },
     };
-    NetworkSignal network_float_signals[] = {
+    NetworkSignal     network_signed_signals[5] = {};
+    NetworkSignalInfo network_float_info[] = {
         { .name = "double_signal", .member_type = "int64_t" },
         { .name = "float_signal", .member_type = "int32_t" },
         { .name = NULL },
     };
+    NetworkSignal     network_float_signals[3] = {};
 
 
     /* Initialize messages with signals array. */
     NetworkMessage network_message[] = {
-        { .name = "example_message", .signals = network_message1_signals },
-        { .name = "example_message2", .signals = network_message2_signals },
-        { .name = "function_example", .signals = network_function_signals },
-        { .name = "unsigned_types", .signals = network_unsigned_signals },
-        { .name = "signed_types", .signals = network_signed_signals },
-        { .name = "float_types", .signals = network_float_signals },
+        { .name = "example_message",
+            .signals = network_message1_signals,
+            .signal_info = network_message1_info },
+        { .name = "example_message2",
+            .signals = network_message2_signals,
+            .signal_info = network_message2_info },
+        { .name = "function_example",
+            .signals = network_function_signals,
+            .signal_info = network_function_info },
+        { .name = "unsigned_types",
+            .signals = network_unsigned_signals,
+            .signal_info = network_unsigned_info },
+        { .name = "signed_types",
+            .signals = network_signed_signals,
+            .signal_info = network_signed_info },
+        { .name = "float_types",
+            .signals = network_float_signals,
+            .signal_info = network_float_info },
         { .name = NULL },
     };
     network.messages = &network_message[0];
@@ -122,23 +141,17 @@ void test_network_load_signal_funcs(void** state)
         network_load_message_lib(&network, "examples/stub/lib/message.so");
     assert_non_null(handle);
     int i, j;
-    for (i = 0; network_message1_signals[i].member_type != NULL; i++) {
+    for (i = 0; network_message1_info[i].member_type != NULL; i++) {
         /* Assertions for null function pointers before loading. */
-        assert_null(network_message1_signals[i].encode_func_int8);
-        assert_null(network_message1_signals[i].decode_func_int8);
-        assert_null(network_message1_signals[i].range_func_int8);
-        assert_null(network_message1_signals[i].encode_func_int16);
-        assert_null(network_message1_signals[i].decode_func_int16);
-        assert_null(network_message1_signals[i].range_func_int16);
+        assert_null(network_message1_signals[i].encode_func);
+        assert_null(network_message1_signals[i].decode_func);
+        assert_null(network_message1_signals[i].range_func);
     }
-    for (j = 0; network_message2_signals[j].member_type != NULL; j++) {
+    for (j = 0; network_message2_info[j].member_type != NULL; j++) {
         /* Assertions for null function pointers before loading. */
-        assert_null(network_message2_signals[j].encode_func_int8);
-        assert_null(network_message2_signals[j].decode_func_int8);
-        assert_null(network_message2_signals[j].range_func_int8);
-        assert_null(network_message2_signals[j].encode_func_int16);
-        assert_null(network_message2_signals[j].decode_func_int16);
-        assert_null(network_message2_signals[j].range_func_int16);
+        assert_null(network_message2_signals[j].encode_func);
+        assert_null(network_message2_signals[j].decode_func);
+        assert_null(network_message2_signals[j].range_func);
     }
 
     assert_int_equal(i, ARRAY_SIZE(network_message1_signals) - 1);
@@ -147,35 +160,208 @@ void test_network_load_signal_funcs(void** state)
     int rc = network_load_signal_funcs(&network);
     assert_int_equal(rc, 0);
 
-    for (i = 0; network_message1_signals[i].member_type != NULL; i++) {
+    /* Types are resolved (signals were not parsed). */
+    assert_int_equal(
+        network_message1_signals[0].type, NETWORK_SIGNAL_TYPE_UINT8);
+    assert_int_equal(
+        network_message1_signals[2].type, NETWORK_SIGNAL_TYPE_INT16);
+    assert_int_equal(
+        network_unsigned_signals[3].type, NETWORK_SIGNAL_TYPE_UINT64);
+    assert_int_equal(
+        network_signed_signals[2].type, NETWORK_SIGNAL_TYPE_INT32);
+
+    for (i = 0; network_message1_info[i].member_type != NULL; i++) {
         /* Assertions for non-null function pointers after loading. */
-        if (strcmp(network_message1_signals[i].member_type, "uint8_t") == 0) {
-            assert_non_null(network_message1_signals[i].encode_func_int8);
-            assert_non_null(network_message1_signals[i].decode_func_int8);
-            assert_non_null(network_message1_signals[i].range_func_int8);
-        } else if (strcmp(network_message1_signals[i].member_type, "int16_t") ==
+        if (strcmp(network_message1_info[i].member_type, "uint8_t") == 0) {
+            assert_non_null(network_message1_signals[i].encode_func);
+            assert_non_null(network_message1_signals[i].decode_func);
+            assert_non_null(network_message1_signals[i].range_func);
+        } else if (strcmp(network_message1_info[i].member_type, "int16_t") ==
                    0) {
-            assert_non_null(network_message1_signals[i].encode_func_int16);
-            assert_non_null(network_message1_signals[i].decode_func_int16);
-            assert_non_null(network_message1_signals[i].range_func_int16);
+            assert_non_null(network_message1_signals[i].encode_func);
+            assert_non_null(network_message1_signals[i].decode_func);
+            assert_non_null(network_message1_signals[i].range_func);
         }
     }
-    for (i = 0; network_message2_signals[i].member_type != NULL; i++) {
+    for (i = 0; network_message2_info[i].member_type != NULL; i++) {
         /* Assertions for non-null function pointers after loading. */
-        if (strcmp(network_message2_signals[i].member_type, "uint8_t") == 0) {
-            assert_non_null(network_message2_signals[i].encode_func_int8);
-            assert_non_null(network_message2_signals[i].decode_func_int8);
-            assert_non_null(network_message2_signals[i].range_func_int8);
-        } else if (strcmp(network_message2_signals[i].member_type, "int16_t") ==
+        if (strcmp(network_message2_info[i].member_type, "uint8_t") == 0) {
+            assert_non_null(network_message2_signals[i].encode_func);
+            assert_non_null(network_message2_signals[i].decode_func);
+            assert_non_null(network_message2_signals[i].range_func);
+        } else if (strcmp(network_message2_info[i].member_type, "int16_t") ==
                    0) {
-            assert_non_null(network_message2_signals[i].encode_func_int16);
-            assert_non_null(network_message2_signals[i].decode_func_int16);
-            assert_non_null(network_message2_signals[i].range_func_int16);
+            assert_non_null(network_message2_signals[i].encode_func);
+            assert_non_null(network_message2_signals[i].decode_func);
+            assert_non_null(network_message2_signals[i].range_func);
         }
     }
 }
 
 
+void test_network_load_descriptor(void** state)
+{
+    UNUSED(state);
+    NetworkSignalInfo example_info[] = {
+        { .name = "temperature", .member_type = "int16_t" },
+        { .name = "enable", .member_type = "uint8_t" },
+        { .name = NULL },
+    };
+    NetworkSignal     example_signals[3] = {};
+    NetworkSignalInfo mux_info[] = {
+        { .name = "foo_double", .member_type = "double" },
+        { .name = NULL },
+    };
+    NetworkSignal     mux_signals[2] = {};
+    NetworkMessage network_message[] = {
+        { .name = "example_message",
+            .signals = example_signals,
+            .signal_info = example_info },
+        { .name = "mux_message" },
+        { .name = "mux_message_601",
+            .container = "mux_message",
+            .signals = mux_signals,
+            .signal_info = mux_info },
+        { .name = NULL },
+    };
+    Network network = { .name = "stub", .messages = network_message };
+
+    /* Load the DLL, functions are loaded from the descriptor. */
+    void* handle =
+        network_load_message_lib(&network, "examples/stub/lib/message.so");
+    assert_non_null(handle);
+    assert_int_equal(network_load_message_funcs(&network), 0);
+    assert_int_equal(network_load_signal_funcs(&network), 0);
+    assert_non_null(network.descriptor);
+    assert_ptr_equal(network.descriptor,
+        dlsym(handle, "stub_network_descriptor"));
+
+    /* Same functions as the symbol lookup. */
+    assert_ptr_equal(network_message[0].pack_func,
+        dlsym(handle, "stub_example_message_pack"));
+    assert_ptr_equal(network_message[0].unpack_func,
+        dlsym(handle, "stub_example_message_unpack"));
+    assert_ptr_equal(network_message[0].marshal_signals,
+        dlsym(handle, "stub_example_message_marshal_signals"));
+    assert_ptr_equal(network_message[0].marshal_tx,
+        dlsym(handle, "stub_example_message_marshal_tx"));
+    assert_ptr_equal(example_signals[0].encode_func,
+        dlsym(handle, "stub_example_message_temperature_encode"));
+    assert_ptr_equal(example_signals[0].range_func,
+        dlsym(handle, "stub_example_message_temperature_is_in_range"));
+    assert_ptr_equal(example_signals[1].decode_func,
+        dlsym(handle, "stub_example_message_enable_decode"));
+
+    /* Container messages use the container functions. */
+    assert_null(network_message[1].marshal_tx);
+    assert_ptr_equal(network_message[2].pack_func,
+        dlsym(handle, "stub_mux_message_pack"));
+    assert_null(network_message[2].marshal_signals);
+    assert_ptr_equal(mux_signals[0].encode_func,
+        dlsym(handle, "stub_mux_message_foo_double_encode"));
+}
+
+
+void test_network_load_lazy_signals(void** state)
+{
+    UNUSED(state);
+    NetworkSignalInfo example_info[] = {
+        { .name = "temperature",
+            .signal_name = "temperature",
+            .member_type = "int16_t" },
+        { .name = "enable",
+            .signal_name = "enable",
+            .member_type = "uint8_t",
+            .init_value = 1 },
+        { .name = "scaled",
+            .signal_name = "scaled",
+            .member_type = "uint8_t",
+            .init_value = 20 },
+        { .name = NULL },
+    };
+    NetworkSignal example_signals[] = {
+        {},
+        { .buffer_offset = 2 },
+        { .buffer_offset = 3,
+            .linear = true,
+            .factor = 0.5,
+            .offset = 10,
+            .minimum = 0,
+            .maximum = 255 },
+        {},
+    };
+    NetworkSignalInfo mux_info[] = {
+        { .name = "header_id",
+            .signal_name = "header_id",
+            .member_type = "uint32_t" },
+        { .name = "header_dlc",
+            .signal_name = "header_dlc",
+            .member_type = "uint8_t" },
+        { .name = NULL },
+    };
+    NetworkSignal mux_signals[] = {
+        { .mux_signal = true },
+        { .internal = true },
+        {},
+    };
+    uint8_t        buffer[8] = { 0 };
+    NetworkMessage network_message[] = {
+        { .name = "example_message",
+            .buffer_len = 8,
+            .buffer = buffer,
+            .signals = example_signals,
+            .signal_info = example_info },
+        { .name = "mux_message",
+            .buffer_len = 8,
+            .signals = mux_signals,
+            .signal_info = mux_info },
+        { .name = NULL },
+    };
+    Network network = { .name = "stub", .messages = network_message };
+
+    /* Only mapped (and internal/mux) signals are active. */
+    const char* filter[] = { "temperature", "foo" };
+    assert_int_equal(network_filter_signals(&network), 1);
+    network.signal_filter = filter;
+    network.signal_filter_count = 2;
+    assert_int_equal(network_filter_signals(&network), 0);
+    assert_false(example_signals[0].inactive);
+    assert_true(example_signals[1].inactive);
+    assert_true(example_signals[2].inactive);
+    assert_false(mux_signals[0].inactive);
+    assert_false(mux_signals[1].inactive);
+
+    /* Functions are loaded for active signals, and for inactive signals
+    without linear scaling (to encode the init_value). */
+    void* handle =
+        network_load_message_lib(&network, "examples/stub/lib/message.so");
+    assert_non_null(handle);
+    assert_int_equal(network_load_signal_funcs(&network), 0);
+    assert_non_null(example_signals[0].encode_func);
+    assert_non_null(example_signals[1].encode_func);
+    assert_null(example_signals[2].encode_func);
+    assert_null(example_signals[2].decode_func);
+    assert_null(example_signals[2].range_func);
+    assert_non_null(mux_signals[0].encode_func);
+    assert_non_null(mux_signals[1].encode_func);
+
+    /* Inactive signals are not marshalled, their init_value is encoded (by
+    the library, or by the linear codec) once. */
+    assert_int_equal(network_load_marshal_lists(&network), 0);
+    MarshalItem* mi = network.marshal_list;
+    assert_ptr_equal(mi[0].signal, &example_signals[0]);
+    assert_ptr_equal(mi[1].signal, &mux_signals[0]);
+    assert_ptr_equal(mi[2].signal, &mux_signals[1]);
+    assert_null(mi[3].signal);
+    assert_int_equal(network_message[0].marshal_count, 1);
+    assert_int_equal(buffer[2], 1);
+    assert_int_equal(buffer[3], 20);
+
+    network_unload_marshal_lists(&network);
+    network_arena_release(&network.arena);
+}
+
+
 void test_network_load_function_lib(void** state)
 {
     UNUSED(state);
@@ -247,6 +433,8 @@ int run_loader_tests(void)
         cmocka_unit_test(test_network_load_message_lib),
         cmocka_unit_test(test_network_load_message_funcs),
         cmocka_unit_test(test_network_load_signal_funcs),
+        cmocka_unit_test(test_network_load_descriptor),
+        cmocka_unit_test(test_network_load_lazy_signals),
         cmocka_unit_test(test_network_load_functions),
     };
 
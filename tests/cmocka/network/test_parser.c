@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <stdio.h>
+#include <unistd.h>
 #include <dse/testing.h>
 #include <dse/logger.h>
 #include <dse/network/network.h>
@@ -72,6 +74,7 @@ int test_network_teardown(void** state)
     NetworkMock* mock = *state;
 
     if (mock && mock->network) {
+        network_unload(mock->network);
         free(mock->network);
     }
     if (mock && mock->model_instance) {
@@ -111,6 +114,8 @@ void test_network_parse_database(void** state)
     assert_int_equal(mock->network->node_id, 2);
     assert_int_equal(mock->network->interface_id, 3);
     assert_int_equal(mock->network->bus_id, 4);
+    assert_int_equal(mock->network->schedule_resolution_us, 1000);
+    assert_false(mock->network->schedule_phase_spread);
 
     network_unload_parser(mock->network);
 }
@@ -142,6 +147,14 @@ void test_network_parse_messages(void** state)
     assert_int_equal(mock->network->messages[0].payload_len, 8);
     assert_non_null(mock->network->messages[0].payload);
     assert_int_equal(mock->network->messages[6].cycle_time_ms, 10);
+    assert_int_equal(mock->network->messages[6].cycle_time_us, 10000);
+    assert_int_equal(mock->network->messages[6].cycle_offset_us, 0);
+    assert_int_equal(
+        mock->network->messages[6].tx_mode, NETWORK_TX_MODE_DEFAULT);
+    assert_int_equal(mock->network->messages[6].tx_min_delay_us, 0);
+    assert_int_equal(mock->network->messages[6].tx_repetitions, 0);
+    assert_int_equal(mock->network->messages[6].rx_timeout_us, 0);
+    assert_null(mock->network->messages[6].rx_timeout_signal);
 
     assert_string_equal(mock->network->messages[1].name, "example_message2");
     assert_string_equal(mock->network->messages[2].name, "function_example");
@@ -156,7 +169,26 @@ void test_network_parse_messages(void** state)
 
     assert_null(mock->network->messages[10].name);  // Null terminating message.
 
+    /* Buffers are held, in message order, by a single aligned slab. */
+    Network* n = mock->network;
+    assert_non_null(n->buffer_slab);
+    assert_int_equal((uintptr_t)n->buffer_slab % 64, 0);
+    uint8_t* p = n->buffer_slab;
+    for (NetworkMessage* nm = n->messages; nm->name; nm++) {
+        if (nm->buffer_len == 0) continue;
+        assert_int_equal((uintptr_t)nm->buffer % 8, 0);
+        assert_int_equal((uintptr_t)nm->payload % 8, 0);
+        assert_true((uint8_t*)nm->buffer >= p);
+        assert_true((uint8_t*)nm->buffer_shadow >= (uint8_t*)nm->buffer +
+                                                       nm->buffer_len);
+        assert_true((uint8_t*)nm->payload >=
+                    (uint8_t*)nm->buffer_shadow + nm->buffer_len);
+        p = (uint8_t*)nm->payload + nm->payload_len;
+    }
+    assert_true(p <= n->buffer_slab + n->buffer_slab_size);
+
     network_unload_parser(mock->network);
+    assert_null(mock->network->buffer_slab);
 }
 
 
@@ -177,37 +209,56 @@ void test_network_parse_signals(void** state)
     network_parse(mock->network, mock->model_instance);
 
     assert_string_equal(
-        mock->network->messages->signals[0].signal_name, "enable");
-    assert_string_equal(mock->network->messages->signals[0].name, "enable");
+        mock->network->messages->signal_info[0].signal_name, "enable");
+    assert_string_equal(mock->network->messages->signal_info[0].name, "enable");
     assert_int_equal(mock->network->messages->signals[0].buffer_offset, 0);
     assert_string_equal(
-        mock->network->messages->signals[0].member_type, "uint8_t");
+        mock->network->messages->signal_info[0].member_type, "uint8_t");
+    assert_int_equal(mock->network->messages->signals[0].type,
+        NETWORK_SIGNAL_TYPE_UINT8);
     assert_double_equal(
-        mock->network->messages->signals[0].init_value, 0.0, 0.0);
+        mock->network->messages->signal_info[0].init_value, 0.0, 0.0);
 
     assert_string_equal(
-        mock->network->messages->signals[1].signal_name, "average_radius");
+        mock->network->messages->signal_info[1].signal_name, "average_radius");
     assert_string_equal(
-        mock->network->messages->signals[1].name, "average_radius");
+        mock->network->messages->signal_info[1].name, "average_radius");
     assert_int_equal(mock->network->messages->signals[1].buffer_offset, 1);
     assert_string_equal(
-        mock->network->messages->signals[1].member_type, "uint8_t");
+        mock->network->messages->signal_info[1].member_type, "uint8_t");
+    assert_int_equal(mock->network->messages->signals[1].type,
+        NETWORK_SIGNAL_TYPE_UINT8);
     assert_double_equal(
-        mock->network->messages->signals[1].init_value, 1.0, 0.0);
+        mock->network->messages->signal_info[1].init_value, 1.0, 0.0);
 
 
     assert_string_equal(
-        mock->network->messages->signals[2].signal_name, "temperature");
+        mock->network->messages->signal_info[2].signal_name, "temperature");
     assert_string_equal(
-        mock->network->messages->signals[2].name, "temperature");
+        mock->network->messages->signal_info[2].name, "temperature");
     assert_int_equal(mock->network->messages->signals[2].buffer_offset, 2);
     assert_string_equal(
-        mock->network->messages->signals[2].member_type, "int16_t");
+        mock->network->messages->signal_info[2].member_type, "int16_t");
+    assert_int_equal(mock->network->messages->signals[2].type,
+        NETWORK_SIGNAL_TYPE_INT16);
+    assert_double_equal(
+        mock->network->messages->signal_info[2].init_value, 265.0, 0.0);
+    assert_true(mock->network->messages->signals[2].linear);
+    assert_double_equal(
+        mock->network->messages->signals[2].factor, 0.01, 0.0);
+    assert_double_equal(
+        mock->network->messages->signals[2].offset, 250.0, 0.0);
     assert_double_equal(
-        mock->network->messages->signals[2].init_value, 265.0, 0.0);
+        mock->network->messages->signals[2].minimum, 229.52, 0.0);
+    assert_double_equal(
+        mock->network->messages->signals[2].maximum, 270.47, 0.0);
+
+    /* Null terminating signal. */
+    assert_null(mock->network->messages->signal_info[3].name);
 
-    assert_null(
-        mock->network->messages->signals[3].name);  // Null terminating signal.
+    /* Signals without scaling annotations (use library functions). */
+    assert_string_equal(mock->network->messages[2].signal_info[0].name, "crc");
+    assert_false(mock->network->messages[2].signals[0].linear);
 
     network_unload_parser(mock->network);
 }
@@ -313,15 +364,15 @@ void test_network_parse_container(void** state)
     assert_int_equal(m->mux_id, 0);
     assert_null(m->mux_signal);  // Not set until marshal list is built.
     // assert_ptr_equal(m->mux_signal, &m->signals[0]);
-    assert_string_equal(m->signals[0].name, "header_id");
+    assert_string_equal(m->signal_info[0].name, "header_id");
     assert_int_equal(m->signals[0].internal, 0);
     assert_int_equal(m->signals[0].mux_signal, 1);
     assert_int_equal(m->signals[0].value, 0);
-    assert_string_equal(m->signals[1].name, "header_dlc");
+    assert_string_equal(m->signal_info[1].name, "header_dlc");
     assert_int_equal(m->signals[1].internal, 0);
     assert_int_equal(m->signals[1].mux_signal, 0);
     assert_int_equal(m->signals[1].value, 0);
-    assert_null(m->signals[2].name);
+    assert_null(m->signal_info[2].name);
 
     m = find_message(mock->network, "mux_message_601");
     assert_non_null(m);
@@ -331,19 +382,19 @@ void test_network_parse_container(void** state)
     assert_string_equal(m->container, "mux_message");
     assert_int_equal(m->mux_id, 601);
     assert_null(m->mux_signal);
-    assert_string_equal(m->signals[0].name, "header_id");
+    assert_string_equal(m->signal_info[0].name, "header_id");
     assert_int_equal(m->signals[0].internal, 1);
     assert_int_equal(m->signals[0].mux_signal, 0);
     assert_int_equal(m->signals[0].value, 601);
-    assert_string_equal(m->signals[1].name, "header_dlc");
+    assert_string_equal(m->signal_info[1].name, "header_dlc");
     assert_int_equal(m->signals[1].internal, 1);
     assert_int_equal(m->signals[1].mux_signal, 0);
     assert_int_equal(m->signals[1].value, 42);
-    assert_string_equal(m->signals[2].name, "foo_double");
+    assert_string_equal(m->signal_info[2].name, "foo_double");
     assert_int_equal(m->signals[2].internal, 0);
     assert_int_equal(m->signals[2].mux_signal, 0);
     assert_int_equal(m->signals[2].value, 0);
-    assert_null(m->signals[3].name);
+    assert_null(m->signal_info[3].name);
 
     m = find_message(mock->network, "mux_message_602");
     assert_non_null(m);
@@ -353,24 +404,214 @@ void test_network_parse_container(void** state)
     assert_string_equal(m->container, "mux_message");
     assert_int_equal(m->mux_id, 602);
     assert_null(m->mux_signal);
-    assert_string_equal(m->signals[0].name, "header_id");
+    assert_string_equal(m->signal_info[0].name, "header_id");
     assert_int_equal(m->signals[0].internal, 1);
     assert_int_equal(m->signals[0].mux_signal, 0);
     assert_int_equal(m->signals[0].value, 602);
-    assert_string_equal(m->signals[1].name, "header_dlc");
+    assert_string_equal(m->signal_info[1].name, "header_dlc");
     assert_int_equal(m->signals[1].internal, 1);
     assert_int_equal(m->signals[1].mux_signal, 0);
     assert_int_equal(m->signals[1].value, 24);
-    assert_string_equal(m->signals[2].name, "bar_float");
+    assert_string_equal(m->signal_info[2].name, "bar_float");
     assert_int_equal(m->signals[2].internal, 0);
     assert_int_equal(m->signals[2].mux_signal, 0);
     assert_int_equal(m->signals[2].value, 0);
-    assert_null(m->signals[3].name);
+    assert_null(m->signal_info[3].name);
 
     network_unload_parser(mock->network);
 }
 
 
+void test_network_parse_image(void** state)
+{
+    UNUSED(state);
+
+    /* Get the Mock objects. */
+    NetworkMock* mock = *state;
+    Network*     n = mock->network;
+    const char*  image_path = "network_image__ut.bin";
+    unlink(image_path);
+
+    /* Parse and load (image does not exist). */
+    network_parse(n, mock->model_instance);
+    assert_null(n->image);
+    network_load_message_lib(n, n->message_lib_path);
+    network_load_signal_funcs(n);
+    network_load_message_funcs(n);
+    n->image_path = image_path;
+    assert_int_not_equal(network_image_load(n), 0);
+    assert_int_equal(network_image_save(n), 0);
+
+    /* Load the image. */
+    Network image = {
+        .name = n->name,
+        .doc = n->doc,
+        .message_lib_path = n->message_lib_path,
+        .image_path = image_path,
+    };
+    assert_int_equal(network_image_load(&image), 0);
+    assert_non_null(image.image);
+    assert_int_equal(network_message_alloc_buffers(&image), 0);
+    network_load_message_lib(&image, image.message_lib_path);
+    assert_int_equal(network_image_resolve(&image), 0);
+
+    /* Compare with the parsed Network. */
+    NetworkMessage* nm = n->messages;
+    NetworkMessage* im = image.messages;
+    for (; nm->name; nm++, im++) {
+        assert_string_equal(im->name, nm->name);
+        assert_int_equal(im->frame_id, nm->frame_id);
+        assert_int_equal(im->frame_type, nm->frame_type);
+        assert_int_equal(im->buffer_len, nm->buffer_len);
+        assert_int_equal(im->payload_len, nm->payload_len);
+        assert_int_equal(im->cycle_time_us, nm->cycle_time_us);
+        assert_int_equal(im->mux_id, nm->mux_id);
+        assert_true(im->container == nm->container ||
+                    strcmp(im->container, nm->container) == 0);
+        assert_non_null(im->buffer);
+        assert_non_null(im->payload);
+        assert_ptr_equal(im->pack_func, nm->pack_func);
+        assert_ptr_equal(im->unpack_func, nm->unpack_func);
+        assert_ptr_equal(im->marshal_tx, nm->marshal_tx);
+        NetworkSignalInfo* ni = nm->signal_info;
+        NetworkSignalInfo* ii = im->signal_info;
+        for (; ni->name; ni++, ii++) {
+            NetworkSignal* ns = &nm->signals[ni - nm->signal_info];
+            NetworkSignal* is = &im->signals[ii - im->signal_info];
+            void *n_enc, *n_dec, *n_rng, *i_enc, *i_dec, *i_rng;
+            assert_string_equal(ii->name, ni->name);
+            assert_string_equal(ii->signal_name, ni->signal_name);
+            assert_string_equal(ii->member_type, ni->member_type);
+            assert_int_equal(is->type, ns->type);
+            assert_int_equal(is->buffer_offset, ns->buffer_offset);
+            assert_int_equal(is->internal, ns->internal);
+            assert_int_equal(is->mux_signal, ns->mux_signal);
+            assert_true(ii->init_value == ni->init_value);
+            network_signal_get_funcs(ns, &n_enc, &n_dec, &n_rng);
+            network_signal_get_funcs(is, &i_enc, &i_dec, &i_rng);
+            assert_non_null(i_enc);
+            assert_ptr_equal(i_enc, n_enc);
+            assert_ptr_equal(i_dec, n_dec);
+            assert_ptr_equal(i_rng, n_rng);
+        }
+        assert_null(ii->name);
+    }
+    assert_null(im->name);
+
+    /* Functions, annotations are resolved from the YAML doc. */
+    NetworkFunction* functions = image.messages[2].encode_functions;
+    assert_string_equal(functions[0].name, "counter_inc_uint8");
+    assert_string_equal(
+        network_function_annotation(&functions[0], "position"), "1");
+    assert_string_equal(functions[1].name, "crc_generate");
+    assert_string_equal(
+        network_function_annotation(&functions[1], "position"), "0");
+    assert_null(functions[2].name);
+    functions = image.messages[2].decode_functions;
+    assert_string_equal(functions[0].name, "crc_validate");
+    assert_non_null(functions[0].annotations);
+    assert_null(functions[1].name);
+
+    /* A different message library does not match the image. */
+    Network stale = {
+        .name = n->name,
+        .doc = n->doc,
+        .message_lib_path = n->function_lib_path,
+        .image_path = image_path,
+    };
+    assert_int_not_equal(network_image_load(&stale), 0);
+    assert_null(stale.image);
+    assert_null(stale.messages);
+
+    network_unload_parser(&image);
+    network_image_unload(&image);
+    network_arena_release(&image.arena);
+    assert_null(image.image);
+
+    /* A signal with a bad type, or outside the message buffer, does not
+    match the image (ImageHeader signal_offset at byte 48, ImageSignal type
+    at byte 12 and buffer_offset at byte 16). */
+    Network corrupt = {
+        .name = n->name,
+        .doc = n->doc,
+        .message_lib_path = n->message_lib_path,
+        .image_path = image_path,
+    };
+    struct {
+        long     offset;
+        uint32_t value;
+    } tc[] = {
+        { 16, 0x10000 },
+        { 12, NETWORK_SIGNAL_TYPE__COUNT },
+    };
+    for (size_t i = 0; i < sizeof(tc) / sizeof(tc[0]); i++) {
+        FILE* f = fopen(image_path, "r+b");
+        assert_non_null(f);
+        uint64_t signal_offset = 0;
+        uint32_t value = 0;
+        assert_int_equal(fseek(f, 48, SEEK_SET), 0);
+        assert_int_equal(fread(&signal_offset, sizeof(signal_offset), 1, f), 1);
+        long offset = signal_offset + tc[i].offset;
+        assert_int_equal(fseek(f, offset, SEEK_SET), 0);
+        assert_int_equal(fread(&value, sizeof(value), 1, f), 1);
+        assert_int_equal(fseek(f, offset, SEEK_SET), 0);
+        assert_int_equal(fwrite(&tc[i].value, sizeof(uint32_t), 1, f), 1);
+        fflush(f);
+        assert_int_not_equal(network_image_load(&corrupt), 0);
+        assert_null(corrupt.image);
+        assert_null(corrupt.messages);
+        /* Restore the record. */
+        assert_int_equal(fseek(f, offset, SEEK_SET), 0);
+        assert_int_equal(fwrite(&value, sizeof(value), 1, f), 1);
+        fclose(f);
+    }
+
+    network_unload_parser(n);
+    unlink(image_path);
+}
+
+
+void test_network_arena(void** state)
+{
+    UNUSED(state);
+
+    NetworkArena arena = { 0 };
+
+    /* Allocations are aligned and zeroed. */
+    char* a = network_arena_alloc(&arena, 3);
+    char* b = network_arena_alloc(&arena, 8);
+    assert_non_null(a);
+    assert_non_null(b);
+    assert_int_equal((uintptr_t)a % 16, 0);
+    assert_int_equal((uintptr_t)b % 16, 0);
+    assert_true(b >= a + 3);
+    for (size_t i = 0; i < 8; i++) {
+        assert_int_equal(b[i], 0);
+    }
+    size_t size = arena.size;
+    assert_true(size > 0);
+
+    /* Strings are copied. */
+    char* s = network_arena_strdup(&arena, "foo");
+    assert_string_equal(s, "foo");
+    assert_null(network_arena_strdup(&arena, NULL));
+
+    /* Large allocations get a block of their own. */
+    char* l = network_arena_alloc(&arena, 1024 * 1024);
+    assert_non_null(l);
+    assert_int_equal((uintptr_t)l % 16, 0);
+    l[1024 * 1024 - 1] = 1;
+    assert_true(arena.size > size + 1024 * 1024);
+    char* c = network_arena_alloc(&arena, 8);
+    assert_ptr_equal(c, s + 16);
+
+    /* Release. */
+    network_arena_release(&arena);
+    assert_null(arena.block);
+    assert_int_equal(arena.size, 0);
+}
+
+
 int run_parser_tests(void)
 {
     void* s = test_network_setup;
@@ -381,6 +622,8 @@ int run_parser_tests(void)
         cmocka_unit_test_setup_teardown(test_network_parse_messages, s, t),
         cmocka_unit_test_setup_teardown(test_network_parse_signals, s, t),
         cmocka_unit_test_setup_teardown(test_network_parse_container, s, t),
+        cmocka_unit_test_setup_teardown(test_network_parse_image, s, t),
+        cmocka_unit_test_setup_teardown(test_network_arena, s, t),
     };
 
     return cmocka_run_group_tests_name("PARSER", tests, NULL, NULL);